@@ -21,7 +21,7 @@ const uint8_t lcd14_15bi_16x17[] PROGMEM =
     17,		    // Character width  ('0' is Variable width font, use below width table each character)
     16,		    // Character height (pixel)
     ' ',	    // First character
-    'e',        // End character 
+    'r',        // End character 
 
 /* 
 **  Font data for LCD 15pt
@@ -1445,6 +1445,266 @@ const uint8_t lcd14_15bi_16x17[] PROGMEM =
 	//  ##########      
 	0x00, 0x00, 0x00, 0xF0, 0xFC, 0xBE, 0x87, 0x83, 0x83, 0x83, 0x81, 0x83, 0xC3, 0xFB, 0x7F, 0x1F, 0x02, 
 	0x60, 0xFC, 0xFF, 0xCF, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2380 'f' (17 pixels wide) rotated 'T' */
+	//                   
+	//      ##           
+	//     ###           
+	//     ##            
+	//    ###            
+	//    ###            
+	//    ##             
+	//    ###########    
+	//   ###########     
+	//   ##              
+	//  ###              
+	//  ###              
+	//  ##               
+	// ###               
+	// ##                
+	//                   
+	0x00, 0x00, 0x00, 0xF0, 0xFC, 0xBE, 0x86, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 
+	0x60, 0x7C, 0x3F, 0x0F, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2414 'g' (17 pixels wide) left arrow */
+	//                   
+	//                   
+	//             ###   
+	//            ###    
+	//            ##     
+	//           ##      
+	//          ##       
+	//          #####    
+	//          ####     
+	//         ##        
+	//         ###       
+	//         ###       
+	//         ###       
+	//          ##       
+	//                   
+	//                   
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xE0, 0xB8, 0x9C, 0x8C, 0x04, 0x00, 0x00, 
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x3F, 0x3D, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2448 'h' (17 pixels wide) right arrow */
+	//                   
+	//                   
+	//       ##          
+	//       ##          
+	//       ###         
+	//       ###         
+	//       ###         
+	//     #####         
+	//    ######         
+	//      ###          
+	//     ###           
+	//    ###            
+	//    ##             
+	//   ##              
+	//                   
+	//                   
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xFC, 0xFC, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+	0x00, 0x00, 0x20, 0x39, 0x1D, 0x0F, 0x07, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2482 'i' (17 pixels wide) all 14 segments */
+	//       ##########  
+	//      ############ 
+	//     #### #######  
+	//     #### #######  
+	//    #############  
+	//    ######### ##   
+	//    ## ##### ###   
+	//    ###########    
+	//   ############    
+	//   ## ##### ###    
+	//  #############    
+	//  ############     
+	//  #### #######     
+	// #### ### ####     
+	// ############      
+	//  ##########       
+	0x00, 0x00, 0x00, 0xF0, 0xFC, 0xBE, 0xFF, 0xFF, 0xF3, 0xFF, 0xFF, 0xBF, 0xDF, 0xFF, 0x7F, 0x1F, 0x02, 
+	0x60, 0xFC, 0xFF, 0xFF, 0xDD, 0xEF, 0xFF, 0xFF, 0xDF, 0xFF, 0xFD, 0x7F, 0x3F, 0x07, 0x00, 0x00, 0x00, 
+
+	/* @2516 'j' (17 pixels wide) hourglass 1 */
+	//       ##########  
+	//       #########   
+	//       ## ######   
+	//       ## #####    
+	//       #######     
+	//       ######      
+	//       #####       
+	//                   
+	//                   
+	//      #####        
+	//     ### ###       
+	//    ###  ###       
+	//    ##   ###       
+	//   ##     ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x73, 0x7F, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF8, 0xDC, 0xCE, 0xC6, 0xC2, 0xDE, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2550 'k' (17 pixels wide) hourglass 2 */
+	//       ##########  
+	//       #########   
+	//       ## ######   
+	//       ## #####    
+	//       #######     
+	//       ######      
+	//       #####       
+	//                   
+	//                   
+	//      #####        
+	//     #######       
+	//    ########       
+	//    ## #####       
+	//   ## ### ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x73, 0x7F, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF8, 0xDC, 0xEE, 0xFE, 0xFE, 0xDE, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2584 'l' (17 pixels wide) hourglass 3 */
+	//       ##########  
+	//       #### ####   
+	//       ##    ###   
+	//       ##   ###    
+	//       ###  ##     
+	//       ### ##      
+	//       #####       
+	//                   
+	//                   
+	//      #####        
+	//     #######       
+	//    ########       
+	//    ## #####       
+	//   ## ### ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x73, 0x43, 0x61, 0x3B, 0x1F, 0x0F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF8, 0xDC, 0xEE, 0xFE, 0xFE, 0xDE, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2618 'm' (17 pixels wide) hourglass 4 */
+	//       ##########  
+	//       #### ####   
+	//       ##    ###   
+	//       ##   ###    
+	//       ###  ##     
+	//       ### ##      
+	//       #####       
+	//     ##########    
+	//    ##########     
+	//      #####        
+	//     ### ###       
+	//    ###  ###       
+	//    ##   ###       
+	//   ##     ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xFF, 0xFF, 0xF3, 0xC3, 0xE1, 0xBB, 0x9F, 0x8F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF9, 0xDD, 0xCF, 0xC7, 0xC3, 0xDF, 0xFF, 0xFD, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2652 'n' (17 pixels wide) hourglass 5 */
+	//       ##########  
+	//       #### ####   
+	//       ##    ###   
+	//       ##   ###    
+	//       ###  ##     
+	//       ### ##      
+	//       #####       
+	//     ##########    
+	//    ##########     
+	//      #####        
+	//     #######       
+	//    ########       
+	//    ## #####       
+	//   ## ### ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0xFF, 0xFF, 0xF3, 0xC3, 0xE1, 0xBB, 0x9F, 0x8F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF9, 0xDD, 0xEF, 0xFF, 0xFF, 0xDF, 0xFF, 0xFD, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2686 'o' (17 pixels wide) hourglass 6 */
+	//       ##########  
+	//       #### ####   
+	//       ##    ###   
+	//       ##   ###    
+	//       ###  ##     
+	//       ### ##      
+	//       #####       
+	//                   
+	//                   
+	//      #####        
+	//     ### ###       
+	//    ###  ###       
+	//    ##   ###       
+	//   ##     ##       
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x73, 0x43, 0x61, 0x3B, 0x1F, 0x0F, 0x07, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF8, 0xDC, 0xCE, 0xC6, 0xC2, 0xDE, 0xFE, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2720 'p' (17 pixels wide) micro */
+	//                   
+	//      ##           
+	//     ###           
+	//     ##            
+	//    ###            
+	//    ###            
+	//    ##             
+	//    ######         
+	//   #######         
+	//   ##   ##         
+	//  ###  ###         
+	//  ###  ###         
+	//  ##   ##          
+	// ###  ###          
+	// ##   ##           
+	//                   
+	0x00, 0x00, 0x00, 0xF0, 0xFC, 0xBE, 0x86, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+	0x60, 0x7C, 0x3F, 0x0F, 0x01, 0x61, 0x7D, 0x3F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2754 'q' (17 pixels wide) not equal */
+	//                   
+	//                   
+	//             ###   
+	//            ###    
+	//            ##     
+	//           ##      
+	//          ##       
+	//     ##########    
+	//    ##########     
+	//      ###          
+	//     ###           
+	//    ###            
+	//    ##             
+	//   ##              
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0xC0, 0xE0, 0xB8, 0x9C, 0x8C, 0x04, 0x00, 0x00, 
+	0x00, 0x80, 0xE0, 0xF9, 0xDD, 0xCF, 0xC7, 0xC3, 0xC1, 0xC1, 0xC1, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 
+
+	/* @2788 'r' (17 pixels wide) sigma */
+	//       ##########  
+	//       #### ####   
+	//       ##          
+	//       ##          
+	//       ###         
+	//       ###         
+	//       ###         
+	//                   
+	//                   
+	//      ###          
+	//     ###           
+	//    ###            
+	//    ##             
+	//   ##              
+	//   #########       
+	//  ##########       
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x7F, 0x73, 0x03, 0x01, 0x03, 0x03, 0x03, 0x03, 0x01, 0x00, 
+	0x00, 0x80, 0xE0, 0xF8, 0xDC, 0xCE, 0xC6, 0xC2, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
 };
 extern const uint8_t lcd14_15bi_16x17[] PROGMEM;
 #endif
@@ -50,9 +50,8 @@
 *  2014-12-22  2:55:53 AM Initial creation (based on Truly Semiconductors MCG2305-A1-E with 192x64 Graphic LCD)
 *
 */
-#include <avr/io.h>
 #include <stdlib.h>
-#include <avr/pgmspace.h>
+#include "hal.h"
 #include "sbn166g.h"
 #include "glcd.h"
 
@@ -60,57 +59,130 @@ uint8_t   _glcd_fontcolor;
  int8_t   _glcd_sbl;        // space between letters;
 
 uint8_t*  _glcd_font;
+fontheader _glcd_fontheader;   // header of _glcd_font, decoded once
+#ifdef FONT_PACKED
+static uint8_t _glcd_pagebuf[FONT_MAX_WIDTH];   // an unpacked glyph page
+#endif
+
+// a glyph being drawn by glcd_putc, page by page
+typedef struct
+{
+  const uint8_t* data;    // next glyph byte (program memory)
+  uint8_t x;              // upper left corner
+  uint8_t y;
+  uint8_t width;          // pixel
+  uint8_t pages;          // pages of the glyph
+  uint8_t page;           // next page to draw
+  uint8_t color;
+  uint8_t packed;         // data is PackBits compressed, see unpack
+  unpacker unpack;
+} glyph;
+
 uint8_t glcd_readfont(const uint8_t* ptr)
 {
   return pgm_read_byte(ptr);
 }
 
+/**
+ * the next byte of a PackBits stream
+ *
+ * @param u the decoder, set src to the packed glyph and count to 0
+ *
+ * One or two flash reads per byte, no buffer: a packet header is read
+ * at the start of a packet, a repeated byte stays in place until its
+ * packet is done.
+ *
+ * @return the unpacked byte
+ */
+#ifdef FONT_PACKED
+uint8_t glcd_unpack(unpacker* u)
+{
+  uint8_t data;
+
+  while(!u->count)
+  {
+    int8_t n = (int8_t)glcd_readfont(u->src++);
+
+    if(n >= 0)
+    {
+      u->count  = n + 1;        // literal
+      u->repeat = 0;
+    }
+    else
+    if(n != -128)
+    {
+      u->count  = 1 - n;        // repeat
+      u->repeat = 1;
+    }
+  }
+
+  u->count--;
+  if(u->repeat)
+  {
+    data = glcd_readfont(u->src);
+    if(!u->count) u->src++;
+  }
+  else
+  {
+    data = glcd_readfont(u->src++);
+  }
+  return data;
+}
+#endif
+
 void glcd_selectfont(const uint8_t* font, uint8_t color, uint8_t type, int8_t sbl)
 {
+  if(_glcd_font != font)
+  {
+    // decode the header once, not for every character
+    uint8_t width = glcd_readfont(font+FONT_FIXED_WIDTH);
+
+    _glcd_fontheader.width   = width & FONT_WIDTH_MASK;
+    _glcd_fontheader.packed  = (width & FONT_PACKBITS) != 0;
+    _glcd_fontheader.offsets = (width & (FONT_OFFSET_TABLE|FONT_PACKBITS)) != 0;
+    _glcd_fontheader.pages = (glcd_readfont(font+FONT_HEIGHT)+7)/8;
+    _glcd_fontheader.first = glcd_readfont(font+FONT_FIRST_CHAR);
+    _glcd_fontheader.count = glcd_readfont(font+FONT_END_CHAR) - _glcd_fontheader.first + 1;
+  }
   _glcd_font  = (uint8_t *)font;  // save new font
   _glcd_fontcolor = color;             // save new font color
   _glcd_sbl       = sbl;               // save Space between letter
 }
 
-/**
- * output a character
- *
- * @param c the character to output
- *
- * If the character will not fit on the current text line
- * inside the text area,
- * the text position is wrapped to the next line.
- *
- */
-void glcd_putc(uint8_t c)
+/*
+ * find the glyph of a character in the selected font
+ * Input: character, returns the width in pixel
+ * Returns: the glyph data (program memory), NULL if not in the font
+*/
+static const uint8_t* _glcd_lookup(uint8_t c, uint8_t* width)
 {
-  if(_glcd_coord.x > LCD_RIGHT)  return;    // reached a end column
-  if(_glcd_coord.y > LCD_BOTTOM) return;    // reached a end row
-  if(c             < 0x20)       return;    // special character
-
  uint16_t index = 0;
-  uint8_t x;        // current X coordinate 0..255
-  uint8_t y;        // current Y coordinate 0..63 (LOOK! datatype uint8_t)
-  uint8_t height    = glcd_readfont(_glcd_font+FONT_HEIGHT);  
-  
-  uint8_t page      = (height+7)/8;
-  uint8_t firstChar = glcd_readfont(_glcd_font+FONT_FIRST_CHAR);  
-  
-  uint8_t charCount = glcd_readfont(_glcd_font+FONT_END_CHAR) - glcd_readfont(_glcd_font+FONT_FIRST_CHAR) + 1;
-  uint8_t width;    // font width pixels
+  uint8_t page      = _glcd_fontheader.pages;
+  uint8_t charCount = _glcd_fontheader.count;
 
-  if(c < firstChar || c >= (firstChar+charCount)) return; // invalid char
+  if(c < 0x20) return NULL;                      // special character
 
-  c-= firstChar;
+  c -= _glcd_fontheader.first;
+  if(c >= charCount) return NULL;                // invalid char
 
-  if(isfixedwidth(_glcd_font))
+  *width = _glcd_fontheader.width;
+  if(_glcd_fontheader.offsets)
   {
-    width = glcd_readfont(_glcd_font+FONT_FIXED_WIDTH);
-    index = c*page*width+FONT_WIDTH_TABLE;
+    // look the glyph up in the offset table, after the width table if any
+    const uint8_t* table  = _glcd_font+FONT_WIDTH_TABLE+(*width ? 0 : charCount);
+    const uint8_t* offset = table+2*c;
+
+    index = (glcd_readfont(offset) << 8) | glcd_readfont(offset+1);
+    index = index+(table-_glcd_font)+2*charCount;
+  }
+  else
+  if(*width)
+  {
+    // fixed width font
+    index = c*page*(*width)+FONT_WIDTH_TABLE;
   }
   else
   {
-    // variable width font, read width data, to get the index
     /*
      * Because there is no table for the offset of where the data
      * for each character glyph starts, run the table and add up all the
@@ -121,33 +193,149 @@ void glcd_putc(uint8_t c)
     for(uint16_t i=0; i<c; i++) index += glcd_readfont(_glcd_font+FONT_WIDTH_TABLE+i);
 
     index = index*page+charCount+FONT_WIDTH_TABLE;
+  }
 
+  if(!*width)
+  {
     // Finally, fetch the width of our character
-    width = glcd_readfont(_glcd_font+FONT_WIDTH_TABLE+c);
+    *width = glcd_readfont(_glcd_font+FONT_WIDTH_TABLE+c);
   }
+  return _glcd_font+index;
+}
+
+/*
+ * set up a glyph for glcd_putc at the current text position
+ * Input: the glyph, the character in the selected font
+ * Returns: 0 if the character is not in the font or off screen
+*/
+static uint8_t _glcd_glyph(glyph* g, uint8_t c)
+{
+  if(_glcd_coord.x > LCD_RIGHT)  return 0;  // reached a end column
+  if(_glcd_coord.y > LCD_BOTTOM) return 0;  // reached a end row
 
-  x = _glcd_coord.x;
-  y = _glcd_coord.y;
+  uint8_t width;
+  const uint8_t* data = _glcd_lookup(c, &width);
 
-  for(uint8_t i=0; i<page; i++)         /* each vertical byte, x axis */
+  if(!data) return 0;
+
+  g->data  = data;
+  g->x     = _glcd_coord.x;
+  g->y     = _glcd_coord.y;
+  g->width = width;
+  g->pages = _glcd_fontheader.pages;
+  g->page  = 0;
+  g->color = _glcd_fontcolor;
+#ifdef FONT_PACKED
+  g->packed = _glcd_fontheader.packed;
+  g->unpack.src   = data;
+  g->unpack.count = 0;
+#endif
+  return 1;
+}
+
+/**
+ * compose one page of a glyph into a line buffer
+ *
+ * @param c the character, in the selected font
+ * @param page the page of the glyph, 0 is the top
+ * @param buf the line buffer, the glyph columns are ORed into it
+ *
+ * Nothing is written to the LCD, the caller streams the buffer
+ * (glcd_write_run) once all the glyphs of the page are in.
+ *
+ * @return the glyph width, 0 if the character or page is not in the font
+ */
+uint8_t glcd_glyphpage(uint8_t c, uint8_t page, uint8_t* buf)
+{
+  uint8_t width;
+  const uint8_t* data = _glcd_lookup(c, &width);
+
+  if(!data || (page >= _glcd_fontheader.pages)) return 0;
+
+#ifdef FONT_PACKED
+  unpacker u = { data, 0, 0 };
+
+  if(_glcd_fontheader.packed)
   {
-    for(uint8_t j=0; j<width; j++)      /* each Horizontal pixel, y axis */
-    {
-      uint8_t data = glcd_readfont(_glcd_font+index+(i*width)+j);
-      if(_glcd_fontcolor == LCD_DOT_XOR)
-      {
-        data = ~data;
-      }
-      glcd_offsetwrite(data);
-    }
+    // unpack the pages above
+    for(uint16_t j=page*width; j; j--) glcd_unpack(&u);
+  }
+  else
+#endif
+  {
+    data += page*width;
+  }
+
+  for(uint8_t j=0; j<width; j++)
+  {
+#ifdef FONT_PACKED
+    uint8_t bits = _glcd_fontheader.packed ? glcd_unpack(&u) : glcd_readfont(data++);
+#else
+    uint8_t bits = glcd_readfont(data++);
+#endif
+
+    buf[j] |= (_glcd_fontcolor == LCD_DOT_XOR) ? ~bits : bits;
+  }
+  return width;
+}
+
+/*
+ * draw the next page (width bytes) of a glyph set up by _glcd_glyph
+ * Input: the glyph
+ * Returns: non zero when the whole glyph is drawn
+*/
+static uint8_t _glcd_glyphstep(glyph* g)
+{
+  uint8_t y = g->y + (g->page*8);
+
+  if((g->page >= g->pages) || (y > LCD_BOTTOM))
+  {
+    return 1;
+  }
 
-    if(_glcd_coord.y+8 > LCD_BOTTOM)
+#ifdef FONT_PACKED
+  if(g->packed)
+  {
+    // unpack the page into the page buffer, then the same single run.
+    // glcdconv refuses packed glyphs wider than FONT_MAX_WIDTH, and a
+    // packed font header checks its widest glyph against it at compile time
+    for(uint8_t j=0; j<g->width; j++)
     {
-      break;
+      _glcd_pagebuf[j] = glcd_unpack(&g->unpack);
     }
-    glcd_gotoxy(x, _glcd_coord.y+8);
+    glcd_offsetwrite_run(g->x, y, _glcd_pagebuf, g->width, g->color);
   }
-  glcd_gotoxy(x+width+_glcd_sbl, y);
+  else
+#endif
+  {
+    // one run per page, streamed or read-modify-write strips if unaligned
+    glcd_offsetwrite_run_P(g->x, y, g->data, g->width, g->color);
+    g->data += g->width;
+  }
+  g->page++;
+
+  return ((g->page >= g->pages) || (y+8 > LCD_BOTTOM));
+}
+
+/**
+ * output a character
+ *
+ * @param c the character to output
+ *
+ * If the character will not fit on the current text line
+ * inside the text area,
+ * the text position is wrapped to the next line.
+ *
+ */
+void glcd_putc(uint8_t c)
+{
+  glyph g;
+
+  if(!_glcd_glyph(&g, c)) return;
+
+  while(!_glcd_glyphstep(&g));
+
+  glcd_gotoxy(g.x+g.width+_glcd_sbl, g.y);
 }
 
 // Character data put string
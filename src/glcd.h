@@ -26,7 +26,7 @@
  * SOFTWARE.
  *
 */
-#include <avr/pgmspace.h>   
+#include "hal.h"
 
 // Font Configuration
 #define FONT_ENGLISH          0   // 0:English Font
@@ -38,19 +38,81 @@
 #define FONT_FIRST_CHAR		  4   
 #define FONT_END_CHAR 		  5   
 #define FONT_WIDTH_TABLE	  6   // bytes
+
+/*
+ * variable width fonts (FONT_FIXED_WIDTH 0) are followed by a width table
+ * of one byte per character, then the glyph data. with FONT_OFFSET_TABLE
+ * in FONT_FIXED_WIDTH a table of 16 bit offsets (high byte first, one per
+ * character, from the start of the glyph data) follows the width table,
+ * so a glyph is found without adding up the widths before it.
+ *
+ * [size][fixed width|FONT_OFFSET_TABLE][height][first][end]
+ * [width table: count][offset table: 2*count][glyph data]
+ *
+ * with FONT_PACKBITS every glyph is PackBits compressed on its own, fixed
+ * or variable width. the offset table is then always there (the glyphs
+ * differ in size) and points at the packed glyphs. a packet is a count
+ * byte n, 0..127: n+1 literal bytes follow, -1..-127: the next byte is
+ * repeated 1-n times, -128: nothing. the unpacked glyph is the same page
+ * after page column data as an uncompressed one.
+ *
+ * the digit font lcd14_15bi_16x17 packs from 2828 to 2183 bytes, drawn
+ * with the same LCD bus cycles and about 10% more host time per character
+ * at the page aligned row (mfhost -f).
+ */
+#define FONT_OFFSET_TABLE     0x80
+#define FONT_PACKBITS         0x40
+#define FONT_WIDTH_MASK       0x3f  // fixed width pixel, 0: variable width
+
+// glyph page buffer of packed fonts, the widest glyph
+#ifndef FONT_MAX_WIDTH
+#define FONT_MAX_WIDTH        32
+#endif
+
+// packed fonts are drawn only with -DFONT_PACKED, the page buffer is then in the SRAM
+#ifdef FONT_PACKED
+#define FONT_PAGEBUF_BYTES    FONT_MAX_WIDTH
+#else
+#define FONT_PAGEBUF_BYTES    0
+#endif
+
+// decoded header of the selected font (glcd_selectfont)
+typedef struct
+{
+  uint8_t width;          // fixed width pixel, 0: variable width
+  uint8_t pages;          // pages of a glyph
+  uint8_t first;          // first character
+  uint8_t count;          // number of characters
+  uint8_t offsets;        // font with an offset table
+  uint8_t packed;         // PackBits compressed glyphs
+} fontheader;
+
+// PackBits decoder state (glcd_unpack)
+typedef struct
+{
+  const uint8_t* src;     // next packed byte (program memory)
+  uint8_t count;          // bytes left in the packet
+  uint8_t repeat;         // the packet repeats *src
+} unpacker;
+
 /*
 * functions relating to bitmap font
 */
 extern void glcd_selectfont(const uint8_t* font, uint8_t color, uint8_t type, int8_t sbl);
 extern uint8_t   glcd_readfont(const uint8_t* ptr);
 extern uint8_t* _glcd_font;
+extern fontheader _glcd_fontheader;
 extern uint8_t  _glcd_fontcolor;
 
 extern void glcd_puts(char *str);
 extern void glcd_puts_p(PGM_P str);
 extern void glcd_putc(uint8_t c);
+extern uint8_t glcd_glyphpage(uint8_t c, uint8_t page, uint8_t* buf);
+#ifdef FONT_PACKED
+extern uint8_t glcd_unpack(unpacker* u);
+#endif
 #define glcd_puts_P(__s) glcd_puts_p(PSTR(__s))
-#define isfixedwidth(font)  (glcd_readfont(font+FONT_FIXED_WIDTH) > 0)
+#define isfixedwidth(font)  ((glcd_readfont(font+FONT_FIXED_WIDTH) & FONT_WIDTH_MASK) > 0)
 #endif
 /*
 * EOF
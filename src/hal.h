@@ -0,0 +1,92 @@
+#ifndef HAL_H_
+#define HAL_H_
+/*
+ * $Id: hal.h ssk  $
+ *
+ * Hardware abstraction of the AVR I/O used by the decoder and the LCD library.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+/*
+ * port and pin access, program memory reads, SPI data register, bus delays
+ *
+ * AVR   : the macros are the register accesses themselves (sbi/cbi/in/out),
+ *         no code is added to the target build.
+ * host  : the I/O registers are RAM (host/hal_host.c), every port write and
+ *         pin read goes through a hook, so a model of the hardware can watch
+ *         the LCD bus and drive the inputs. program memory is plain memory.
+ *
+ * all port and pin accesses of the decoder and the LCD library use
+ * HAL_OUT/HAL_SET/HAL_CLR/HAL_IN, never the registers directly.
+ */
+#if defined(__AVR__)
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+#define HAL_OUT(port, value)     ((port) = (value))
+#define HAL_SET(port, mask)      ((port) |= (mask))
+#define HAL_CLR(port, mask)      ((port) &= ~(mask))
+#define HAL_IN(pin)              (pin)
+#define HAL_SPI_DATA()           (SPDR)
+#define HAL_DELAY_CYCLES(n)      __builtin_avr_delay_cycles(n)
+
+#else
+
+#include <stdint.h>
+
+// program memory
+#define PROGMEM
+#define PGM_P                    const char*
+#define PSTR(s)                  (s)
+#define pgm_read_byte(p)         (*(const uint8_t*)(p))
+
+#define _BV(bit)                 (1 << (bit))
+
+// I/O registers of the ATmega8 used by the application
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+extern volatile uint8_t SPDR, SPSR, SPCR;
+
+// called after a port write and before a pin read, NULL:plain registers
+extern void (*hal_port_hook)(volatile uint8_t* port);
+extern void (*hal_pin_hook)(volatile uint8_t* pin);
+
+extern void    hal_port_write(volatile uint8_t* port, uint8_t value);
+extern uint8_t hal_pin_read(volatile uint8_t* pin);
+
+#define HAL_OUT(port, value)     hal_port_write(&(port), (value))
+#define HAL_SET(port, mask)      hal_port_write(&(port), (port) | (mask))
+#define HAL_CLR(port, mask)      hal_port_write(&(port), (port) & ~(mask))
+#define HAL_IN(pin)              hal_pin_read(&(pin))
+#define HAL_SPI_DATA()           (SPDR)
+#define HAL_DELAY_CYCLES(n)      ((void)(n))
+
+#endif
+
+#endif
+/*
+ * EOF
+ */
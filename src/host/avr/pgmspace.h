@@ -0,0 +1,5 @@
+/*
+ * host build: the fonts and bitmaps include <avr/pgmspace.h>,
+ * program memory is plain memory (hal.h)
+ */
+#include "hal.h"
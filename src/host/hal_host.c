@@ -0,0 +1,59 @@
+/*
+ * $Id: hal_host.c ssk  $
+ *
+ * Host side of hal.h, the I/O registers of the ATmega8 in RAM.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+#include <stddef.h>
+#include "hal.h"
+
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+volatile uint8_t SPDR, SPSR, SPCR;
+
+void (*hal_port_hook)(volatile uint8_t* port);
+void (*hal_pin_hook)(volatile uint8_t* pin);
+
+/*
+ * write an output register, the hook sees the new value
+ */
+void hal_port_write(volatile uint8_t* port, uint8_t value)
+{
+  *port = value;
+  if(hal_port_hook) hal_port_hook(port);
+}
+
+/*
+ * read an input register, the hook may drive it first
+ */
+uint8_t hal_pin_read(volatile uint8_t* pin)
+{
+  if(hal_pin_hook) hal_pin_hook(pin);
+  return *pin;
+}
+/*
+ * EOF
+ */
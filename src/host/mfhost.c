@@ -0,0 +1,540 @@
+/*
+ * $Id: mfhost.c ssk  $
+ *
+ * Host driver of the decoder and the renderer, for tests and benchmarks.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+/*
+ * usage: mfhost [-n frames] [-o screen.pbm] [-g golden.pbm] [-s] [-l] [-f] [capture]
+ *
+ * the bus bytes of a capture, or of synthetic frames counting up, go into
+ * the capture ring as the SPI ISR puts them and through the main loop of
+ * main.c (MF_Poll). the LCD library drives the SBN166G model (sbn166g_emu.c)
+ * through the port hooks of hal.h, its bus cycles are counted from the
+ * first frame on and the panel is saved as a PBM image at the end (-o).
+ *
+ * checks, the exit status is 1 when one fails:
+ *   -g  the panel at the end is compared with a PBM image pixel by pixel
+ *   -s  unaligned read-modify-write strips over a pattern, every pixel of
+ *       the panel is compared with the pattern ORed with the strip
+ *   -l  the welcome logo scrolled out through the display start line, the
+ *       panel is compared with the logo moved up after every line
+ *
+ * -f compares the packed digit font with the plain one before the frames
+ *
+ * capture : text, whitespace separated tokens
+ *   c<hex>  command byte (SYNC high, ISA)
+ *   d<hex>  data byte (SYNC low, INA)
+ *   -       end of a burst (PWO falling edge), the renderer runs
+ *   #       comment up to the end of the line
+ *
+ * the host clock (MF_TICK_NS units) advances by MF_HOST_BURST during a burst
+ * and by MF_HOST_IDLE after it, it stands still while rendering, so every
+ * frame is rendered in the idle window that follows it.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal.h"
+#include "sbn166g.h"
+#include "glcd.h"
+#include "hp6060b.h"
+#include "render.h"
+#include "sbn166g_emu.h"
+#include "lcd14_pk.h"          // the digit font repacked (-f)
+
+extern const uint8_t lcd14_15bi_16x17[];   // render.c
+
+#define MF_HOST_BURST        3    // ticks of a burst
+#define MF_HOST_IDLE         60   // ticks between two bursts
+
+static uint16_t hostTicks;        // the host clock
+
+static long     hostBursts;
+static double   hostBurstNs;      // start of the burst being decoded
+static double   hostDecodeNs;
+static double   hostRenderNs;
+
+static double host_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+uint16_t sched_now(void)
+{
+  return hostTicks;
+}
+
+uint16_t sched_budget(void)
+{
+  return MF_IdleBudget(hostTicks);
+}
+
+uint16_t sched_window(void)
+{
+  return mfBus.end;
+}
+
+// a bus burst starts, PWO high
+static void host_burst(void)
+{
+  PIND |= _BV(CTRL_PWO);
+  MF_BusActive(hostTicks);
+  hostBurstNs = host_ns();
+}
+
+// a bus byte, into the capture ring as ISR(SPI_STC_vect) puts it
+static void host_byte(uint8_t data, uint8_t sync)
+{
+  uint8_t head = mfRing.head;
+
+  // the main loop drains the ring during a burst too
+  if(((head + 1) & MF_RING_MASK) == mfRing.tail) MF_Decode();
+
+  mfRing.data[head] = data;
+  mfRing.sync[head] = sync;
+  mfRing.head = (head + 1) & MF_RING_MASK;
+}
+
+/*
+ * the burst is over (PWO low), the main loop of main.c runs until the
+ * frame is on the LCD
+ */
+static void host_idle(void)
+{
+  double t;
+  uint8_t poll;
+
+  hostTicks += MF_HOST_BURST;
+  PIND &= ~_BV(CTRL_PWO);
+  MF_BusIdle(hostTicks);
+  hostBursts++;
+
+  MF_Decode();
+  hostDecodeNs += host_ns() - hostBurstNs;
+
+  t = host_ns();
+  do
+  {
+    poll = MF_Poll();
+  }
+  while(poll & MF_POLL_BUSY);
+  if(poll & MF_POLL_DONE) hostRenderNs += host_ns() - t;
+
+  hostTicks += MF_HOST_IDLE;
+}
+
+/*
+ * replay a capture file
+ */
+static void host_capture(const char* file)
+{
+  FILE* fp = fopen(file, "r");
+  char  token[64];
+
+  if(!fp)
+  {
+    fprintf(stderr, "mfhost: can not open %s\n", file);
+    exit(1);
+  }
+  host_burst();
+  while(fscanf(fp, "%63s", token) == 1)
+  {
+    if(token[0] == '#')
+    {
+      int c;
+      while(((c = fgetc(fp)) != EOF) && (c != '\n'));
+    }
+    else
+    if(token[0] == '-')
+    {
+      host_idle();
+      host_burst();
+    }
+    else
+    if(token[0] == 'c' || token[0] == 'd')
+    {
+      host_byte((uint8_t)strtoul(token+1, NULL, 16), token[0] == 'c');
+    }
+    else
+    {
+      fprintf(stderr, "mfhost: bad token %s\n", token);
+      exit(1);
+    }
+  }
+  host_idle();
+  fclose(fp);
+}
+
+/*
+ * a frame showing text (12 cells), dots and annunciators as the 6060B sends it
+ *
+ * text  : ' ' and '0'..'9', the register code is the character itself
+ * dots  : bit i set, a '.' after the cell i
+ */
+static void host_frame(const char* text, uint16_t dots, uint16_t annunciators)
+{
+  uint8_t a[MF_SZ_REGISTER_A], b[MF_SZ_REGISTER_B], c[MF_SZ_REGISTER_C];
+
+  memset(a, 0, sizeof(a));
+  memset(b, 0, sizeof(b));
+  memset(c, 0, sizeof(c));
+  for(uint8_t i=0; i<MF_MAX_DIGIT; i++)
+  {
+    uint8_t code = text[i] & 0x7f;
+    uint8_t dot  = (dots >> i) & 1;
+
+    if(i & 1)
+    {
+      a[i/2] |= code & 0x0f;
+      b[i/2] |= ((code >> 4) & 0x03) | (dot ? 0x04 : 0);
+      c[i/2] |= (code >> 6) & 0x01;
+    }
+    else
+    {
+      a[i/2] |= (code & 0x0f) << 4;
+      b[i/2] |= (code & 0x30) | (dot ? 0x40 : 0);
+      c[i/2] |= (code & 0x40) >> 2;
+    }
+  }
+
+  // the data of a register are sent last byte first
+  host_burst();
+  host_byte(MF_START_MF, 1);
+  host_byte(MF_UNCHECK_2E0, 1);
+  host_byte(MF_REGISTER_A, 1);
+  for(int8_t i=MF_SZ_REGISTER_A-1; i>=0; i--) host_byte(a[i], 0);
+  host_byte(MF_REGISTER_B, 1);
+  for(int8_t i=MF_SZ_REGISTER_B-1; i>=0; i--) host_byte(b[i], 0);
+  host_byte(MF_ANNUNCIATOR, 1);
+  host_byte(annunciators & 0xff, 0);
+  host_byte(annunciators >> 8, 0);
+  host_byte(MF_REGISTER_C, 1);
+  for(int8_t i=MF_SZ_REGISTER_C-1; i>=0; i--) host_byte(c[i], 0);
+  host_idle();
+}
+
+static void host_report(void)
+{
+  printf("frames  started:%u completed:%u rendered:%u skipped:%u blanked:%u\n",
+         mfStats.started, mfStats.completed, mfStats.rendered, mfStats.skipped, mfStats.blanked);
+  printf("lost    torn:%u rejected:%u replaced:%u overflow:%u\n",
+         mfStats.torn, mfStats.rejected, mfStats.dropped, mfRing.overflow);
+  printf("bus     bytes:%u unknown:%u bursts:%ld\n", mfStats.bytes, mfStats.unknown, hostBursts);
+  printf("timing  period:%u idle:%u step:%u (x%luns)\n", mfBus.period, mfBus.idle, MF_STEP_COST(), MF_TICK_NS);
+  printf("host    decode:%.1fns/byte render:%.2fus/frame\n",
+         mfStats.bytes ? hostDecodeNs / mfStats.bytes : 0.0,
+         mfStats.rendered ? hostRenderNs / mfStats.rendered / 1000.0 : 0.0);
+  emu_print_stats();
+  if(mfStats.rendered)
+  {
+    printf("lcd     cycles/frame:%.1f\n",
+           (double)(emuStats.cmdCycles + emuStats.writeCycles + emuStats.readCycles + emuStats.dummyCycles) / mfStats.rendered);
+  }
+}
+
+/*
+ * packed and plain font compared (-f)
+ *
+ * the digit font of the renderer, as it is and repacked by glcdconv -p
+ * (lcd14_pk.h, make host). every character is drawn page aligned and
+ * unaligned, the flash size, the host time and the LCD bus cycles per
+ * character are printed for both.
+ */
+static void host_fonts(void)
+{
+  static const struct { const char* name; const uint8_t* font; } fonts[] =
+  {
+    { "plain ", lcd14_15bi_16x17 },
+    { "packed", lcd14_pk },
+  };
+
+  for(uint8_t i=0; i<sizeof(fonts)/sizeof(fonts[0]); i++)
+  {
+    const uint8_t* font = fonts[i].font;
+    uint16_t size  = (pgm_read_byte(font) << 8) | pgm_read_byte(font+1);
+    uint8_t  first = pgm_read_byte(font+FONT_FIRST_CHAR);
+    uint8_t  end   = pgm_read_byte(font+FONT_END_CHAR);
+    uint8_t  width = pgm_read_byte(font+FONT_FIXED_WIDTH);
+
+    // The Font Factory leaves the size 0, a fixed width font is a plain array
+    if(!size && width && !(width & ~FONT_WIDTH_MASK))
+    {
+      size = FONT_WIDTH_TABLE + (end - first + 1) * width * ((pgm_read_byte(font+FONT_HEIGHT) + 7) / 8);
+    }
+
+    for(uint8_t y=8; y<=11; y+=3)
+    {
+      unsigned long cycles;
+      double t;
+
+      glcd_clear(0x00);
+      glcd_selectfont(font, LCD_DOT_SET, FONT_ENGLISH, 0);
+      emu_reset_stats();
+      t = host_ns();
+      for(uint16_t c=first; c<=end; c++)
+      {
+        glcd_gotoxy(0, y);
+        glcd_putc(c);
+      }
+      t = host_ns() - t;
+      cycles = emuStats.cmdCycles + emuStats.writeCycles + emuStats.readCycles + emuStats.dummyCycles;
+      printf("font    %s size:%u y:%u host:%.0fns/char lcd:%.1fcycles/char\n", fonts[i].name, size, y,
+             t / (end - first + 1), (double)cycles / (end - first + 1));
+    }
+  }
+  glcd_clear(0x00);
+}
+
+/*
+ * unaligned read-modify-write strips over a pattern (-s)
+ *
+ * the strips cross both chip boundaries, every pixel of the panel has to
+ * show the pattern ORed with the strip (LCD_DOT_SET) or with the inverted
+ * strip (LCD_DOT_XOR). returns the number of wrong pixels.
+ */
+static long host_strips(void)
+{
+  static const uint8_t ys[] = { 1, 3, 7, 12, 19, 27 };
+  uint8_t bg[LCD_X_BYTES], src[LCD_X_BYTES];
+  uint8_t x0 = 3, len = LCD_X_BYTES - 12;
+  long bad = 0;
+
+  for(uint8_t i=0; i<sizeof(ys); i++)
+  {
+    for(uint8_t color=LCD_DOT_SET; color<=LCD_DOT_XOR; color++)
+    {
+      uint8_t y = ys[i];
+
+      for(uint8_t x=0; x<LCD_X_BYTES; x++)
+      {
+        bg[x]  = (x * 37) ^ 0x5a ^ y;
+        src[x] = (x * 91) ^ 0xc3 ^ color;
+      }
+      for(uint8_t page=0; page<LCD_Y_BYTES; page++)
+      {
+        glcd_write_run(0, page, bg, LCD_X_BYTES);
+      }
+      glcd_offsetwrite_run(x0, y, src, len, color);
+
+      for(uint8_t py=0; py<=LCD_BOTTOM; py++)
+      {
+        for(uint8_t x=0; x<LCD_X_BYTES; x++)
+        {
+          uint8_t expect = (bg[x] >> (py & 7)) & 1;
+
+          if((x >= x0) && (x < x0 + len) && (py >= y) && (py < y + 8))
+          {
+            uint8_t data = (color == LCD_DOT_XOR) ? ~src[x - x0] : src[x - x0];
+            expect |= (data >> (py - y)) & 1;
+          }
+          if(emu_pixel(x, py) != expect) bad++;
+        }
+      }
+    }
+  }
+  return bad;
+}
+
+/*
+ * the welcome logo scrolled out (-l)
+ *
+ * after every line of MF_ScrollLogo the panel has to show the logo moved
+ * up by the start line of the SBN166G model, with the pages cleared so far
+ * blank, and the model has to agree with _glcd_start_line. at the end the
+ * panel is blank at start line 0. returns the number of wrong pixels.
+ */
+static long host_scroll(void)
+{
+  static uint8_t logo[LCD_BOTTOM+1][LCD_X_BYTES];
+  long bad = 0;
+
+  MF_DrawLogo();
+  for(uint8_t y=0; y<=LCD_BOTTOM; y++)
+  {
+    for(uint8_t x=0; x<LCD_X_BYTES; x++)
+    {
+      logo[y][x] = emu_pixel(x, y);
+    }
+  }
+  emu_reset_stats();
+  for(uint8_t line=0; line<=LCD_BOTTOM; line++)
+  {
+    uint8_t start = (line + 1) & LCD_BOTTOM;
+
+    MF_ScrollLogo(line);
+    for(uint8_t chip=0; chip<EMU_CHIPS; chip++)
+    {
+      if(emuChip[chip].startLine != _glcd_start_line) bad++;
+    }
+    for(uint8_t y=0; y<=LCD_BOTTOM; y++)
+    {
+      uint8_t ram = (y + start) & LCD_BOTTOM;
+
+      for(uint8_t x=0; x<LCD_X_BYTES; x++)
+      {
+        uint8_t expect = ((ram >> 3) > (line >> 3)) ? logo[ram][x] : 0;
+
+        if(emu_pixel(x, y) != expect) bad++;
+      }
+    }
+  }
+  if(_glcd_start_line) bad++;
+  printf("scroll  cycles command:%lu write:%lu read:%lu\n",
+         emuStats.cmdCycles, emuStats.writeCycles, emuStats.readCycles + emuStats.dummyCycles);
+  return bad;
+}
+
+/*
+ * compare the panel with a PBM image (-g)
+ *
+ * returns the number of wrong pixels, -1 when the image can not be read.
+ */
+static long host_golden(const char* file)
+{
+  FILE* fp = fopen(file, "rb");
+  int   width, height;
+  long  bad = 0;
+
+  if(!fp) return -1;
+  if((fscanf(fp, "P4 %d %d", &width, &height) != 2) || (fgetc(fp) == EOF) ||
+     (width != LCD_X_BYTES) || (height != LCD_BOTTOM + 1))
+  {
+    fclose(fp);
+    return -1;
+  }
+  for(uint8_t y=0; y<=LCD_BOTTOM; y++)
+  {
+    int bits = 0;
+
+    for(uint8_t x=0; x<LCD_X_BYTES; x++)
+    {
+      if(!(x & 7) && ((bits = fgetc(fp)) == EOF))
+      {
+        fclose(fp);
+        return -1;
+      }
+      if(((bits >> (7 - (x & 7))) & 1) != emu_pixel(x, y)) bad++;
+    }
+  }
+  fclose(fp);
+  return bad;
+}
+
+int main(int argc, char* argv[])
+{
+  long frames = 1000;
+  const char* file = NULL;
+  const char* screen = NULL;
+  const char* golden = NULL;
+  uint8_t strips = 0, fonts = 0, scroll = 0;
+  int fail = 0;
+
+  for(int i=1; i<argc; i++)
+  {
+    if(!strcmp(argv[i], "-n") && i+1 < argc) frames = atol(argv[++i]);
+    else
+    if(!strcmp(argv[i], "-o") && i+1 < argc) screen = argv[++i];
+    else
+    if(!strcmp(argv[i], "-g") && i+1 < argc) golden = argv[++i];
+    else
+    if(!strcmp(argv[i], "-s")) strips = 1;
+    else
+    if(!strcmp(argv[i], "-f")) fonts = 1;
+    else
+    if(!strcmp(argv[i], "-l")) scroll = 1;
+    else
+    if(argv[i][0] != '-' && !file) file = argv[i];
+    else
+    {
+      fprintf(stderr, "usage: mfhost [-n frames] [-o screen.pbm] [-g golden.pbm] [-s] [-l] [-f] [capture]\n");
+      return 1;
+    }
+  }
+
+  emu_init();
+  glcd_init();
+  MF_InitFrameBuffer();
+  if(strips)
+  {
+    long bad = host_strips();
+
+    printf("check   strips: %ld pixels wrong\n", bad);
+    fail |= (bad != 0);
+  }
+  if(scroll)
+  {
+    long bad = host_scroll();
+
+    printf("check   scroll: %ld pixels wrong\n", bad);
+    fail |= (bad != 0);
+  }
+  if(fonts) host_fonts();
+  glcd_clear(0x00);
+  MF_InitCells();
+  emu_reset_stats();
+
+  if(file)
+  {
+    host_capture(file);
+  }
+  else
+  {
+    char text[MF_MAX_DIGIT+1];
+
+    // a reading counting up, every frame differs in the last digits
+    for(long n=0; n<frames; n++)
+    {
+      snprintf(text, sizeof(text), "%12ld", n % 1000000L);
+      host_frame(text, _BV(MF_MAX_DIGIT-4), _BV(n % MF_MAX_DIGIT));
+    }
+  }
+  host_report();
+  if(screen && emu_write_pbm(screen))
+  {
+    fprintf(stderr, "mfhost: can not write %s\n", screen);
+    return 1;
+  }
+  if(golden)
+  {
+    long bad = host_golden(golden);
+
+    if(bad < 0)
+    {
+      fprintf(stderr, "mfhost: can not read %s\n", golden);
+      return 1;
+    }
+    printf("check   %s: %ld pixels wrong\n", golden, bad);
+    fail |= (bad != 0);
+  }
+  return fail;
+}
+/*
+ * EOF
+ */
@@ -0,0 +1,294 @@
+/*
+ * $Id: sbn166g_emu.c ssk  $
+ *
+ * Host model of the WG20232A module, three SBN166G controllers on the
+ * 68-type bus of sbn166g.h, driven through the port hooks of hal.h.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+/*
+ * the bus is decoded from the port writes of sbn166g.c:
+ *
+ * E rising , R/W high : the chip drives the output latch on D0-D7 (PIN
+ *                       registers), the latch is then loaded from the RAM
+ * E falling, R/W low  : A0 low a command, A0 high a data byte is written
+ *
+ * the output latch is loaded by a read only (SBN1661G data sheet v6.7, 8.2
+ * Read Display Data, Fig. 16: a write goes from the bus straight into the
+ * RAM). a read advances the column outside the Read-Modify-Write mode, a
+ * write always does. so after an address set, a write or RMW END the latch
+ * does not hold the column, the next read returns it as it is and counts as
+ * a dummy read.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "sbn166g.h"
+#include "sbn166g_emu.h"
+
+tEmuChip  emuChip[EMU_CHIPS];
+tEmuStats emuStats;
+
+static const uint8_t emuStartX[EMU_CHIPS] = { LCD_CHIP1_START_X, LCD_CHIP2_START_X, LCD_CHIP3_START_X };
+static const uint8_t emuEndX[EMU_CHIPS]   = { LCD_CHIP2_START_X, LCD_CHIP3_START_X, LCD_X_BYTES };
+static uint8_t emuE;              // E levels of the chips, bit n:chip n
+
+static void emu_port_hook(volatile uint8_t* port);
+static uint8_t emu_enables(void);
+static void emu_read(uint8_t chip);
+static void emu_write(uint8_t chip, uint8_t data);
+static void emu_command(uint8_t chip, uint8_t cmd);
+static void emu_reload(tEmuChip* c);
+
+/*
+ * plug the model in under sbn166g.c, the chips come up as after a reset
+ * with the display off and the RAM cleared
+ */
+void emu_init(void)
+{
+  memset(emuChip, 0, sizeof(emuChip));
+  for(uint8_t chip=0; chip<EMU_CHIPS; chip++)
+  {
+    emuChip[chip].page = EMU_PAGES - 1;
+  }
+  emuE = 0;
+  emu_reset_stats();
+  hal_port_hook = emu_port_hook;
+}
+
+void emu_reset_stats(void)
+{
+  memset(&emuStats, 0, sizeof(emuStats));
+}
+
+// E levels of the three chips on the ports
+static uint8_t emu_enables(void)
+{
+  return ((LCD_CHIP1_PORT & _BV(LCD_CS1_PIN)) ? 1 : 0) |
+         ((LCD_CHIP2_PORT & _BV(LCD_CS2_PIN)) ? 2 : 0) |
+         ((LCD_CHIP3_PORT & _BV(LCD_CS3_PIN)) ? 4 : 0);
+}
+
+/*
+ * a port was written, look for E edges
+ */
+static void emu_port_hook(volatile uint8_t* port)
+{
+  uint8_t e    = emu_enables();
+  uint8_t rise = e & ~emuE;
+  uint8_t fall = emuE & ~e;
+  uint8_t read = (LCD_CONTROL_PORT & _BV(LCD_RW_PIN)) != 0;
+  uint8_t data = (LCD_CONTROL_PORT & _BV(LCD_A0_PIN)) != 0;
+
+  (void)port;
+  if(!rise && !fall) return;
+
+  // a bus cycle starts with the first E going high
+  if(rise && !emuE)
+  {
+    uint8_t chip = (rise & 1) ? 0 : (rise & 2) ? 1 : 2;
+
+    if(read && !emuChip[chip].latchValid) emuStats.dummyCycles++;
+    else if(read) emuStats.readCycles++;
+    else if(data) emuStats.writeCycles++;
+    else          emuStats.cmdCycles++;
+  }
+  emuE = e;
+
+  for(uint8_t chip=0; chip<EMU_CHIPS; chip++)
+  {
+    if(read && (rise & _BV(chip)))
+    {
+      if(e & ~_BV(chip)) emuStats.conflicts++;
+      emu_read(chip);
+    }
+    if(!read && (fall & _BV(chip)))
+    {
+      uint8_t bus = (LCD_DATA_H_PORT & 0xf0) | (LCD_DATA_L_PORT & 0x0f);
+
+      if(data) emu_write(chip, bus);
+      else     emu_command(chip, bus);
+    }
+  }
+}
+
+// load the output latch from the column
+static void emu_reload(tEmuChip* c)
+{
+  c->latch      = c->ram[c->page][c->col];
+  c->latchValid = 1;
+}
+
+static void emu_read(uint8_t chip)
+{
+  tEmuChip* c = &emuChip[chip];
+
+  emuStats.reads[chip]++;
+
+  // the latch goes out on D0-D7
+  LCD_DATA_H_INPUT = (LCD_DATA_H_INPUT & 0x0f) | (c->latch & 0xf0);
+  LCD_DATA_L_INPUT = (LCD_DATA_L_INPUT & 0xf0) | (c->latch & 0x0f);
+
+  emu_reload(c);
+  if(!c->rmw) c->col = (c->col + 1) % EMU_COLS;
+}
+
+static void emu_write(uint8_t chip, uint8_t data)
+{
+  tEmuChip* c = &emuChip[chip];
+
+  emuStats.writes[chip]++;
+  c->ram[c->page][c->col] = data;
+  c->col = (c->col + 1) % EMU_COLS;
+  c->latchValid = 0;                // the latch is not reloaded
+}
+
+static void emu_command(uint8_t chip, uint8_t cmd)
+{
+  tEmuChip* c = &emuChip[chip];
+
+  emuStats.commands[chip]++;
+  if((cmd & 0xfc) == LCD_SET_PAGE)
+  {
+    c->page = cmd & 0x03;
+    c->latchValid = 0;
+    emuStats.addressCmds++;
+  }
+  else
+  if(cmd < LCD_SET_COL + EMU_COLS)
+  {
+    c->col = cmd - LCD_SET_COL;
+    c->latchValid = 0;
+    emuStats.addressCmds++;
+  }
+  else
+  if((cmd & 0xe0) == LCD_START_LINE)
+  {
+    c->startLine = cmd & 0x1f;
+  }
+  else
+  {
+    switch(cmd)
+    {
+      case LCD_DISP_OFF:      c->on = 0;          break;
+      case LCD_DISP_ON:       c->on = 1;          break;
+      case LCD_SET_ADC_NOR:   c->adcReverse = 0;  break;
+      case LCD_SET_ADC_REV:   c->adcReverse = 1;  break;
+      case LCD_STATIC_OFF:    c->staticDrive = 0; break;
+      case LCD_STATIC_ON:     c->staticDrive = 1; break;
+      case LCD_DUTY_16:       c->duty32 = 0;      break;
+      case LCD_DUTY_32:       c->duty32 = 1;      break;
+
+      case LCD_SET_RMW_START:
+           c->rmw    = 1;
+           c->rmwCol = c->col;
+           break;
+
+      case LCD_SET_RMW_END:
+           if(c->rmw) c->col = c->rmwCol;
+           c->rmw = 0;
+           c->latchValid = 0;
+           break;
+
+      case LCD_RESET:
+           c->startLine  = 0;
+           c->col        = 0;
+           c->page       = EMU_PAGES - 1;
+           c->rmw        = 0;
+           c->latchValid = 0;
+           break;
+
+      default:
+           emuStats.unknownCmds++;
+           break;
+    }
+  }
+}
+
+/*
+ * a pixel of the panel as it is shown, 1:dark
+ *
+ * the display row y shows the RAM line (y + start line) % 32 of the chip,
+ * a chip with the display off shows nothing.
+ */
+uint8_t emu_pixel(uint8_t x, uint8_t y)
+{
+  uint8_t chip = (x < LCD_CHIP2_START_X) ? 0 : (x < LCD_CHIP3_START_X) ? 1 : 2;
+  const tEmuChip* c = &emuChip[chip];
+  uint8_t col  = x - emuStartX[chip];
+  uint8_t line = (y + c->startLine) & 0x1f;
+
+  if(!c->on) return 0;
+  if(c->adcReverse) col = emuEndX[chip] - emuStartX[chip] - 1 - col;
+
+  return (c->ram[line >> 3][col] >> (line & 7)) & 1;
+}
+
+/*
+ * screenshot of the panel, binary PBM (P4) of LCD_X_BYTES x 32 pixels
+ *
+ * returns 0 when written.
+ */
+int emu_write_pbm(const char* file)
+{
+  FILE* fp = fopen(file, "wb");
+
+  if(!fp) return -1;
+  fprintf(fp, "P4\n%d %d\n", LCD_X_BYTES, LCD_BOTTOM + 1);
+  for(uint8_t y=0; y<=LCD_BOTTOM; y++)
+  {
+    uint8_t bits = 0;
+
+    for(uint8_t x=0; x<LCD_X_BYTES; x++)
+    {
+      bits = (bits << 1) | emu_pixel(x, y);
+      if((x & 7) == 7)
+      {
+        fputc(bits, fp);
+        bits = 0;
+      }
+    }
+    if(LCD_X_BYTES & 7) fputc(bits << (8 - (LCD_X_BYTES & 7)), fp);
+  }
+  return fclose(fp) ? -1 : 0;
+}
+
+void emu_print_stats(void)
+{
+  printf("lcd     cycles command:%lu write:%lu read:%lu dummy:%lu address:%lu\n",
+         emuStats.cmdCycles, emuStats.writeCycles, emuStats.readCycles,
+         emuStats.dummyCycles, emuStats.addressCmds);
+  for(uint8_t chip=0; chip<EMU_CHIPS; chip++)
+  {
+    printf("lcd%u    command:%lu write:%lu read:%lu\n", chip + 1,
+           emuStats.commands[chip], emuStats.writes[chip], emuStats.reads[chip]);
+  }
+  if(emuStats.unknownCmds || emuStats.conflicts)
+  {
+    printf("lcd     unknown commands:%lu read conflicts:%lu\n", emuStats.unknownCmds, emuStats.conflicts);
+  }
+}
+/*
+ * EOF
+ */
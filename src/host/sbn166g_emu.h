@@ -0,0 +1,83 @@
+#ifndef SBN166G_EMU_H_
+#define SBN166G_EMU_H_
+/*
+ * $Id: sbn166g_emu.h ssk  $
+ *
+ * Host model of the WG20232A module, three SBN166G controllers on the
+ * 68-type bus of sbn166g.h, driven through the port hooks of hal.h.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+#define EMU_CHIPS            3
+#define EMU_COLS             80   // display RAM columns of a SBN166G
+#define EMU_PAGES            4    // display RAM pages of a SBN166G (32 lines)
+
+// one SBN166G
+typedef struct
+{
+  uint8_t ram[EMU_PAGES][EMU_COLS];
+  uint8_t page;                     // page address register
+  uint8_t col;                      // column address register
+  uint8_t rmw;                      // in the Read-Modify-Write mode
+  uint8_t rmwCol;                   // column restored by RMW END
+  uint8_t latch;                    // output latch, returned by the next read
+  uint8_t latchValid;               // the latch was loaded from the column by a read
+  uint8_t on;                       // display on
+  uint8_t startLine;                // RAM line of the top row
+  uint8_t adcReverse;               // column/segment mapping reversed
+  uint8_t staticDrive;              // static drive (power save)
+  uint8_t duty32;                   // 1/32 duty
+} tEmuChip;
+
+/*
+ * bus transaction counters, all of them can be reset (emu_reset_stats)
+ *
+ * a bus cycle is one E pulse, a command strobed into several chips at once
+ * is one bus cycle and one command per chip.
+ */
+typedef struct
+{
+  unsigned long cmdCycles;          // command write cycles
+  unsigned long writeCycles;        // data write cycles
+  unsigned long readCycles;         // data read cycles, dummy reads not included
+  unsigned long dummyCycles;        // dummy read cycles, the latch did not hold the column
+  unsigned long commands[EMU_CHIPS];
+  unsigned long writes[EMU_CHIPS];
+  unsigned long reads[EMU_CHIPS];
+  unsigned long addressCmds;        // page and column commands (all chips)
+  unsigned long unknownCmds;        // bytes that are not a SBN166G command
+  unsigned long conflicts;          // reads with more than one chip enabled
+} tEmuStats;
+
+extern tEmuChip  emuChip[EMU_CHIPS];
+extern tEmuStats emuStats;
+
+// function prototype
+extern void emu_init(void);
+extern void emu_reset_stats(void);
+extern uint8_t emu_pixel(uint8_t x, uint8_t y);
+extern int emu_write_pbm(const char* file);
+extern void emu_print_stats(void);
+
+#endif
@@ -0,0 +1,425 @@
+/*
+ * $Id: hp6060b.c 10:12 AM 10/17/2026 ssk  $
+ *
+ * HP 6060B Display protocol decoding.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+#include <string.h>           // memset
+#include "hal.h"
+#include "hp6060b.h"
+
+static void MF_SwapFrameBuffer(void);
+static void MF_OpenFrame(void);
+static void MF_RejectFrame(void);
+static void MF_CommitFrame(void);
+
+/*
+ * raw bus capture ring
+ *
+ * filled by the SPI ISR with (SPDR, SYNC level) pairs, drained by MF_Decode()
+ */
+tMFRing mfRing;
+
+/*
+ * front/back message frame pair
+ *
+ * the decoder fills the back buffer, the main loop renders the front buffer.
+ * a complete frame is published by swapping the two pointers, so the renderer always
+ * works on a stable snapshot and nothing has to be cleared on the hot path.
+ */
+static tMessageFrame  tMF[MF_SZ_BUFFER][MF_SZ_COMMAND];
+static tMessageFrame* mfFront = tMF[0];
+static tMessageFrame* mfBack  = tMF[1];
+static uint8_t        mfFlags = 0;      // MF_FLAG_READY | MF_FLAG_BUSY | MF_FLAG_PENDING
+
+/*
+ * decoder state
+ *
+ * mfSeq    : sequence number of the next register expected (MF_SEQ_IDLE:no open frame)
+ * mfCur    : message frame entry of the current register (NULL:not a register)
+ * mfDest   : one past the next data byte (data are received in reverse order)
+ * mfRemain : data bytes still expected for the current register
+ */
+static uint8_t        mfSeq = MF_SEQ_IDLE;
+static tMessageFrame* mfCur;
+static uint8_t*       mfDest;
+static uint8_t        mfRemain = 0;
+static uint8_t        mfDisplay = MF_DISPLAY_ON_BIT;   // data of the last MF_DISPLAY_ONOFF
+
+tMFStats mfStats;
+tMFBus   mfBus;
+
+/*
+ * command byte -> (sequence, index, data size), indexed by MF_CMD_KEY(command)
+ *
+ * the key is unique for the 7 commands of the message frame, the stored command
+ * byte rejects everything else. the index is only used for the registers A, B, C
+ * and the annunciator.
+ */
+static const tMFCommand MF_CommandTable[MF_SZ_CMD_TABLE] PROGMEM =
+{
+  [MF_CMD_KEY(MF_START_MF)]      = { MF_START_MF,      MF_SEQ_START,         0,                  0                 },
+  [MF_CMD_KEY(MF_UNCHECK_2E0)]   = { MF_UNCHECK_2E0,   MF_SEQ_UNCHECK_2E0,   0,                  0                 },
+  [MF_CMD_KEY(MF_REGISTER_A)]    = { MF_REGISTER_A,    MF_SEQ_REGISTER_A,    MF_IDX_REGISTER_A,  MF_SZ_REGISTER_A  },
+  [MF_CMD_KEY(MF_REGISTER_B)]    = { MF_REGISTER_B,    MF_SEQ_REGISTER_B,    MF_IDX_REGISTER_B,  MF_SZ_REGISTER_B  },
+  [MF_CMD_KEY(MF_ANNUNCIATOR)]   = { MF_ANNUNCIATOR,   MF_SEQ_ANNUNCIATOR,   MF_IDX_ANNUNCIATOR, MF_SZ_ANNUNCIATOR },
+  [MF_CMD_KEY(MF_REGISTER_C)]    = { MF_REGISTER_C,    MF_SEQ_REGISTER_C,    MF_IDX_REGISTER_C,  MF_SZ_REGISTER_C  },
+  [MF_CMD_KEY(MF_DISPLAY_ONOFF)] = { MF_DISPLAY_ONOFF, MF_SEQ_DISPLAY_ONOFF, 0,                  MF_SZ_DISPLAY     },
+};
+
+void MF_InitFrameBuffer(void)
+{
+  memset(&tMF, 0, sizeof(tMF));
+  mfFront  = tMF[0];
+  mfBack   = tMF[1];
+  mfFlags  = 0;
+  mfSeq    = MF_SEQ_IDLE;
+  mfCur    = NULL;
+  mfRemain = 0;
+  mfDisplay = MF_DISPLAY_ON_BIT;
+  memset(&mfStats, 0, sizeof(mfStats));
+}
+
+/*
+ * publish the back buffer as the new front buffer
+ *
+ * only the valid flags of the new back buffer are cleared,
+ * the data bytes are always overwritten before they are marked valid again.
+ */
+static void MF_SwapFrameBuffer(void)
+{
+  tMessageFrame* mf = mfFront;
+
+  if(mfFlags & MF_FLAG_READY)
+  {
+    mfStats.dropped++;              // the previous frame was never rendered
+  }
+  mfFront = mfBack;
+  mfBack  = mf;
+
+  for(uint8_t i=0; i<MF_SZ_COMMAND; i++)
+  {
+    mf[i].valid = MF_DATA_INVALID;
+  }
+  mfFlags = (mfFlags & ~MF_FLAG_PENDING) | MF_FLAG_READY;
+}
+
+/*
+ * take the front buffer for rendering
+ *
+ * returns NULL when no new frame was published since the last render.
+ * while the frame is held (MF_FLAG_BUSY) the decoder will not swap the buffers.
+ */
+tMessageFrame* MF_AcquireFrame(void)
+{
+  if(mfFlags & MF_FLAG_READY)
+  {
+    mfFlags = (mfFlags & ~MF_FLAG_READY) | MF_FLAG_BUSY;
+    return mfFront;
+  }
+  return NULL;
+}
+
+/*
+ * give the front buffer back to the decoder
+ *
+ * a frame completed while rendering is published right away.
+ */
+void MF_ReleaseFrame(void)
+{
+  mfFlags &= ~MF_FLAG_BUSY;
+  if(mfFlags & MF_FLAG_PENDING)
+  {
+    MF_SwapFrameBuffer();
+  }
+}
+
+/*
+ * open a new frame on MF_START_MF
+ *
+ * a complete frame still waiting for the renderer is superseded,
+ * the back buffer is reused for the new frame.
+ */
+static void MF_OpenFrame(void)
+{
+  if(mfSeq != MF_SEQ_IDLE)
+  {
+    mfStats.torn++;                 // the previous frame was never completed
+  }
+  if(mfFlags & MF_FLAG_PENDING)
+  {
+    mfStats.dropped++;              // completed while rendering, never published
+    mfFlags &= ~MF_FLAG_PENDING;
+  }
+  mfStats.started++;
+  for(uint8_t i=0; i<MF_SZ_COMMAND; i++)
+  {
+    mfBack[i].valid = MF_DATA_INVALID;
+  }
+  mfSeq    = MF_SEQ_REGISTER_A;
+  mfCur    = NULL;
+  mfRemain = 0;
+}
+
+/*
+ * drop the current frame (wrong order or wrong byte count)
+ *
+ * everything up to the next MF_START_MF is ignored.
+ */
+static void MF_RejectFrame(void)
+{
+  mfStats.rejected++;
+  mfSeq    = MF_SEQ_IDLE;
+  mfCur    = NULL;
+  mfRemain = 0;
+}
+
+/*
+ * the last register of the frame is complete, publish it
+ */
+static void MF_CommitFrame(void)
+{
+  mfSeq = MF_SEQ_IDLE;
+  mfCur = NULL;
+  mfStats.completed++;
+
+  if(mfFlags & MF_FLAG_BUSY)
+  {
+    mfFlags |= MF_FLAG_PENDING;     // published by MF_ReleaseFrame()
+  }
+  else
+  {
+    MF_SwapFrameBuffer();
+  }
+}
+
+/*
+ * decode one byte of the display bus
+ *
+ * data : command or data that corresponding to the command
+ * sync : SYNC level when the byte was received (non zero:command from ISA, 0:data from INA)
+ *
+ * a frame is opened by MF_START_MF and has to deliver the registers in the
+ * order A, B, annunciator, C with exactly the data size of MF_CommandTable[].
+ * only such a complete frame is published to the front buffer, anything else
+ * is counted in mfStats (rejected or torn) and dropped.
+ * MF_UNCHECK_2E0 and MF_DISPLAY_ONOFF do not take part in the sequence,
+ * the MF_DISPLAY_ONOFF data are kept for MF_isDisplayOn().
+ *
+ * does not touch any hardware, so recorded traces can be fed through the same path.
+ */
+void MF_DecodeByte(uint8_t data, uint8_t sync)
+{
+  mfStats.bytes++;
+
+  if(sync)
+  {
+    /*
+     * if SYNC Logic High(1), command field in the message frame(from ISA)
+     */
+    const tMFCommand* cmd = &MF_CommandTable[MF_CMD_KEY(data)];
+    uint8_t seq;
+
+    if(pgm_read_byte(&cmd->cmd) != data)
+    {
+      seq = MF_SEQ_UNKNOWN;
+      mfStats.unknown++;
+    }
+    else
+    {
+      seq = pgm_read_byte(&cmd->seq);
+    }
+
+    if(seq == MF_SEQ_START)
+    {
+      MF_OpenFrame();
+      return;
+    }
+    if(mfRemain > 0)
+    {
+      mfRemain = 0;
+      if(mfCur)
+      {
+        MF_RejectFrame();           // previous register is short of data
+      }
+    }
+    if(seq == MF_SEQ_DISPLAY_ONOFF)
+    {
+      mfCur    = NULL;
+      mfRemain = pgm_read_byte(&cmd->dsz);
+      mfDest   = &mfDisplay + 1;
+      return;
+    }
+    if(mfSeq == MF_SEQ_IDLE)
+    {
+      return;                       // not inside a frame
+    }
+
+    switch(seq)
+    {
+      case MF_SEQ_REGISTER_A:
+      case MF_SEQ_REGISTER_B:
+      case MF_SEQ_ANNUNCIATOR:
+      case MF_SEQ_REGISTER_C:
+           if(seq != mfSeq)
+           {
+             MF_RejectFrame();      // out of order
+             break;
+           }
+           mfRemain   = pgm_read_byte(&cmd->dsz);
+           mfCur      = &mfBack[pgm_read_byte(&cmd->idx)];
+           mfCur->cmd = data;
+           mfCur->dsz = mfRemain;
+           mfDest     = &mfCur->data[mfRemain];
+           mfSeq      = seq + 1;
+           break;
+
+      case MF_SEQ_UNKNOWN:
+           MF_RejectFrame();
+           break;
+
+      // below not part of the sequence - ignored
+      case MF_SEQ_UNCHECK_2E0:
+      default:
+           mfCur = NULL;
+           break;
+    }
+  }
+  else
+  {
+    /*
+     * if SYNC Logic Low(0), one or more data that corresponding to the command(from INA)
+     * it depends on the previous "command" received
+     */
+    if(mfRemain > 0)
+    {
+      // data are received in reverse order, we have to reorder them
+      *--mfDest = data;
+
+      if((--mfRemain == 0) && mfCur)
+      {
+        mfCur->valid = MF_DATA_VALID;  // data are received.
+
+        if(mfSeq == MF_SEQ_COMPLETE)
+        {
+          MF_CommitFrame();
+        }
+      }
+    }
+    else
+    if(mfCur)
+    {
+      MF_RejectFrame();             // more data than the register holds
+    }
+  }
+}
+
+/*
+ * display state requested by the 6060B (MF_DISPLAY_ONOFF)
+ *
+ * returns non zero while the display is on.
+ */
+uint8_t MF_isDisplayOn(void)
+{
+  return (mfDisplay & MF_DISPLAY_ON_BIT);
+}
+
+/*
+ * bus timing model
+ *
+ * MF_BusActive() is called on the first SYNC edge of a burst, MF_BusIdle()
+ * on the PWO falling edge, both from interrupt context with a time stamp.
+ * the frame period and the idle gap are learned as moving averages (1/8).
+ */
+void MF_BusActive(uint16_t now)
+{
+  if(mfBus.end != mfBus.start)
+  {
+    uint16_t period = now - mfBus.start;
+    uint16_t idle   = now - mfBus.end;
+
+    if(mfBus.learned)
+    {
+      mfBus.period += ((int16_t)(period - mfBus.period)) / 8;
+      mfBus.idle   += ((int16_t)(idle   - mfBus.idle))   / 8;
+    }
+    else
+    {
+      mfBus.period  = period;
+      mfBus.idle    = idle;
+      mfBus.learned = 1;
+    }
+  }
+  mfBus.start  = now;
+  mfBus.active = 1;
+}
+
+void MF_BusIdle(uint16_t now)
+{
+  if(mfBus.active)
+  {
+    mfBus.end    = now;
+    mfBus.active = 0;
+  }
+}
+
+/*
+ * ticks left until the next burst is expected
+ *
+ * 0 while a burst is running or the window is used up,
+ * MF_IDLE_UNKNOWN as long as the bus timing has not been learned.
+ */
+uint16_t MF_IdleBudget(uint16_t now)
+{
+  uint16_t elapsed;
+
+  if(mfBus.active) return 0;
+  if(!mfBus.learned) return MF_IDLE_UNKNOWN;
+
+  elapsed = now - mfBus.end + MF_IDLE_MARGIN;
+  if(elapsed >= mfBus.idle) return 0;
+
+  return mfBus.idle - elapsed;
+}
+
+/*
+ * drain the capture ring
+ *
+ * called from the main loop, never from interrupt context.
+ */
+void MF_Decode(void)
+{
+  uint8_t tail = mfRing.tail;
+
+  while(tail != mfRing.head)
+  {
+    MF_DecodeByte(mfRing.data[tail], mfRing.sync[tail]);
+    tail = (tail + 1) & MF_RING_MASK;
+    mfRing.tail = tail;
+  }
+}
+/*
+ * EOF
+ */
@@ -77,14 +77,34 @@
 #define MF_SZ_REGISTER_B     6 
 #define MF_SZ_REGISTER_C     6
 #define MF_SZ_ANNUNCIATOR    2    
+#define MF_SZ_PAYLOAD        (MF_SZ_REGISTER_A + MF_SZ_REGISTER_B + MF_SZ_REGISTER_C + MF_SZ_ANNUNCIATOR)
 //#define MF_SZ_START_MF       1    // an unused - ignored  
 //#define MF_SZ_UNCHECK_2E0    1    // an unused - ignored 
-//#define MF_SZ_DISPLAY        1    // an unused - ignored 
+#define MF_SZ_DISPLAY        1
 
-#define isDataBusActive()   (bit_is_set(CTRL_INPUT, CTRL_PWO))
-#define isDataBusIdle()     (bit_is_clear(CTRL_INPUT, CTRL_PWO))
-#define isCommand()         (bit_is_set(CTRL_INPUT, CTRL_SYNC))
-#define isData()            (bit_is_clear(CTRL_INPUT, CTRL_SYNC))
+// sequence number in message frame (order of transmission)
+#define MF_SEQ_START         0
+#define MF_SEQ_UNCHECK_2E0   1
+#define MF_SEQ_REGISTER_A    2
+#define MF_SEQ_REGISTER_B    3
+#define MF_SEQ_ANNUNCIATOR   4
+#define MF_SEQ_REGISTER_C    5
+#define MF_SEQ_COMPLETE      6    // expected after register C, the frame is complete
+#define MF_SEQ_DISPLAY_ONOFF 7
+#define MF_SEQ_UNKNOWN       0xfe // not a message frame command
+#define MF_SEQ_IDLE          0xff // no frame open
+
+/*
+* command lookup key : bits 2..6 of the command byte
+* 0xfc:0x1f, 0xb8:0x0e, 0x0a:0x02, 0x1a:0x06, 0xbc:0x0f, 0x2a:0x0a, 0xc8:0x12
+*/
+#define MF_CMD_KEY(c)        (((c) >> 2) & 0x1f)
+#define MF_SZ_CMD_TABLE      32
+
+#define isDataBusActive()   (HAL_IN(CTRL_INPUT) & _BV(CTRL_PWO))
+#define isDataBusIdle()     (!(HAL_IN(CTRL_INPUT) & _BV(CTRL_PWO)))
+#define isCommand()         (HAL_IN(CTRL_INPUT) & _BV(CTRL_SYNC))
+#define isData()            (!(HAL_IN(CTRL_INPUT) & _BV(CTRL_SYNC)))
 
 // Magic numbers
 #define MF_SZ_COMMAND        4    // command count per message frame
@@ -92,12 +112,79 @@
 #define MF_MAX_DIGIT         12   
 #define MF_DATA_VALID        1    // message frame are received (display ready)
 #define MF_DATA_INVALID      0
+#define MF_SZ_BUFFER         2    // front/back message frame buffers
+#define MF_FLAG_READY        0x01 // a new frame has been published to the front buffer
+#define MF_FLAG_BUSY         0x02 // the front buffer is being rendered
+#define MF_FLAG_PENDING      0x04 // the back buffer holds a complete frame waiting for the renderer
+#define MF_SZ_RING           64   // raw bus capture entries, must be a power of two
+#define MF_RING_MASK         (MF_SZ_RING - 1)
+#if (MF_SZ_RING & MF_RING_MASK)
+ #error MF_SZ_RING must be a power of two
+#endif
+
+/*
+* static RAM (bytes) of the capture ring, the frame buffers and the cell
+* keys, from the sizes they are declared with. main.c checks them, with the
+* font page buffer and the LCD shadow, against the SRAM of the target.
+*
+* MF_RAM_OTHER and MF_RAM_STACK are estimates, not measured: the rest of
+* .data/.bss and the stack depth have to be checked with avr-size and the
+* map file of a build before a larger LCD_SHADOW window is trusted.
+*/
+#define MF_RAM_RING          (2 * MF_SZ_RING + 4)
+#define MF_RAM_FRAMES        (MF_SZ_BUFFER * MF_SZ_COMMAND * (MF_SZ_DATA + 3))
+#define MF_RAM_CELLS         (2 * MF_SZ_ROW * MF_MAX_DIGIT + MF_SZ_PAYLOAD + MF_CELL_PITCH)
+#define MF_RAM_OTHER         128  // estimate: statistics, bus model, pointers, LCD cursor and chip tables, stdout
+#define MF_RAM_STACK         160  // estimate: stack reserve, ISR frames and printf_P of the debug build
+
+#define MF_DISPLAY_ON_BIT    0x01 // MF_DISPLAY_ONOFF data, '1':display on '0':display blanked
 #define MF_ANNUNCIATOR_CHAR  127  // '▼' Annunciator character code (system_5_5x7.h)
 #define MF_PUNCT_NONE        32   // ' ' Punctuation character code (hp6060b_punct.h)
 #define MF_PUNCT_COMMA       33   // ',' Punctuation character code (hp6060b_punct.h)
 #define MF_PUNCT_DOT         34   // '.' Punctuation character code (hp6060b_punct.h)
 #define MF_PUNCT_COLON       35   // ':' Punctuation character code (hp6060b_punct.h)
 
+// bus timing model and render scheduler
+#define TIMER1_TOP           (F_CPU / 1000UL - 1) // Timer1 CTC top, 1ms at F_CPU (no prescaler)
+#if (TIMER1_TOP > 0xffff)
+ #error TIMER1_TOP does not fit the 16 bit Timer1 at F_CPU, use a prescaler
+#endif
+#define MF_TICK_SHIFT        4    // time stamp units per millisecond, 1 << MF_TICK_SHIFT
+#define MF_TICK_NS           (1000000UL >> MF_TICK_SHIFT) // time stamp unit (62.5us)
+#define MF_TICK_SCALE        ((65536UL << MF_TICK_SHIFT) / (TIMER1_TOP + 1)) // TCNT1 high byte to units (x1/256)
+#if ((((TIMER1_TOP >> 8) * MF_TICK_SCALE) >> 8) >= (1 << MF_TICK_SHIFT)) || (MF_TICK_SCALE > 255)
+ #error MF_TICK_SCALE does not fit TIMER1_TOP at F_CPU
+#endif
+#define MF_IDLE_MARGIN       2    // ticks kept free before the predicted next burst
+#define MF_IDLE_UNKNOWN      0xffff // no idle window learned yet, render freely
+#define MF_STEP_COST_INIT    2    // initial guess of one render step, a cell page (ticks)
+
+// rendered LCD pages (rows) of a cell, composed from the glyphs they show
+#define MF_ROW_UPPER         0    // upper half of the digit
+#define MF_ROW_LOWER         1    // lower half of the digit | punctuation
+#define MF_ROW_ANNUNCIATOR   2    // annunciator
+#define MF_SZ_ROW            3
+#define MF_ROW_PAGE(row)     (MF_DIGIT_Y / 8 + (row))
+#define MF_RENDER_JOBS       (MF_SZ_ROW * MF_MAX_DIGIT)
+
+// LCD cell geometry (pixel), one cell per digit
+#define MF_CELL_PITCH        17   // digit width(17) = punctuation(2+15) = annunciator(5+12)
+#define MF_DIGIT_X(i)        (0  + (i) * MF_CELL_PITCH)
+#define MF_DIGIT_Y           8
+#define MF_PUNCT_X(i)        (14 + (i) * MF_CELL_PITCH)
+#define MF_PUNCT_Y           16
+#define MF_ANNUNCIATOR_X(i)  (4  + (i) * MF_CELL_PITCH)
+#define MF_ANNUNCIATOR_Y     24
+
+// command lookup entry (MF_CommandTable)
+typedef struct
+{
+  uint8_t cmd;      // command byte, rejects keys that are not a command
+  uint8_t seq;      // sequence number in message frame
+  uint8_t idx;      // command index in message frame structure
+  uint8_t dsz;      // data size, 0:not a register
+} tMFCommand;
+
 // message frame structure
 typedef struct
 {
@@ -106,5 +193,58 @@ typedef struct
   uint8_t data[MF_SZ_DATA];
   uint8_t valid;
 } tMessageFrame;
+
+// raw bus capture ring, (SPDR, SYNC level) pairs
+typedef struct
+{
+  volatile uint8_t  data[MF_SZ_RING];
+  volatile uint8_t  sync[MF_SZ_RING];
+  volatile uint8_t  head;           // next entry written by the SPI ISR
+  volatile uint8_t  tail;           // next entry read by MF_Decode()
+  volatile uint16_t overflow;       // bytes lost because the ring was full
+} tMFRing;
+
+// frame statistics (telemetry), all counters wrap around
+typedef struct
+{
+  uint16_t started;                 // frames opened by MF_START_MF
+  uint16_t completed;               // frames published to the front buffer
+  uint16_t rendered;                // frames drawn on the LCD
+  uint16_t skipped;                 // frames not drawn, same contents as the LCD
+  uint16_t blanked;                 // frames not drawn, the display is blanked
+  uint16_t rejected;                // frames dropped for wrong order or byte count
+  uint16_t torn;                    // frames interrupted by the next MF_START_MF
+  uint16_t dropped;                 // completed frames replaced before the renderer took them
+  uint16_t bytes;                   // SPI bytes decoded
+  uint16_t unknown;                 // unknown command bytes
+  uint16_t wdtResets;               // watchdog resets since power on (MCUCSR.WDRF)
+  uint16_t renderMs;                // duration of the last render
+} tMFStats;
+
+// bus activity timing model (MF_TICK_NS units), updated from INT0/INT1
+typedef struct
+{
+  uint8_t  active;                  // inside a burst (first SYNC edge .. PWO falling)
+  uint8_t  learned;                 // period and idle gap are valid
+  uint16_t start;                   // last burst start
+  uint16_t end;                     // last burst end
+  uint16_t period;                  // burst start to burst start (moving average)
+  uint16_t idle;                    // burst end to next burst start (moving average)
+} tMFBus;
+
+extern tMFRing  mfRing;
+extern tMFStats mfStats;
+extern tMFBus   mfBus;
+
+// function prototype
+extern void MF_InitFrameBuffer(void);
+extern void MF_DecodeByte(uint8_t data, uint8_t sync);
+extern void MF_Decode(void);
+extern tMessageFrame* MF_AcquireFrame(void);
+extern void MF_ReleaseFrame(void);
+extern uint8_t MF_isDisplayOn(void);
+extern void MF_BusActive(uint16_t now);
+extern void MF_BusIdle(uint16_t now);
+extern uint16_t MF_IdleBudget(uint16_t now);
         
 #endif
\ No newline at end of file
@@ -26,40 +26,53 @@
  * SOFTWARE.
  *
 */
-#include <avr/io.h>
+#include "hal.h"
 #include <avr/interrupt.h>
 #include <avr/wdt.h>
 #include <util/delay.h>
 #include <util/atomic.h>
-#include <string.h>           // memset
+#include <string.h>           // memcmp, memcpy
 #include "sbn166g.h"
 #include "glcd.h"
 #include "hp6060b.h"
 #include "spi.h"
-#include "fonts/allfonts.h"
-#include "bitmaps/allbitmaps.h"
+#include "render.h"
+
+// the static buffers, the LCD shadow window and the stack share the SRAM
+#ifndef RAMSTART
+#define RAMSTART             0x60
+#endif
+#if (MF_RAM_RING + MF_RAM_FRAMES + MF_RAM_CELLS + FONT_PAGEBUF_BYTES + LCD_SHADOW_BYTES + MF_RAM_OTHER + MF_RAM_STACK) > (RAMEND + 1 - RAMSTART)
+ #error the LCD_SHADOW window does not fit into the SRAM, make it smaller
+#endif
+
+#define MF_SCROLL_MS         16   // a line of the welcome scroll (ms)
 
 static void setup(void);
 static void timer1_init(void);
 static void welcome(void);
+static void check_reset(void);
 
-static void MF_InitFrameBuffer(void);
-static void MF_DisplayDigit(void);
-static void MF_DisplayPunctuation(void);
-static void MF_DisplayAnnunciator(void);
-static uint8_t MF_DigitLookup(uint8_t data);
-static uint8_t MF_PunctuationLookup(uint8_t data);
-static uint8_t MF_isValid(void);
-
-tMessageFrame tMF[MF_SZ_COMMAND];
+static uint16_t timer1_ticks(void);
 
 volatile uint16_t milliseconds=0;
 
+// survives a watchdog reset, cleared on power on (check_reset)
+static uint16_t wdtResets __attribute__((section(".noinit")));
+
 #ifdef __DEBUG_MODE__
 #include <stdio.h>            // FILE
 #include "uart_simple.h"
 FILE mystdout = FDEV_SETUP_STREAM(uart_putchar, NULL, _FDEV_SETUP_WRITE);
 uint16_t lastActiveTime;
+static void MF_PrintStats(void);
+
+/*
+* the uart is transmit only, its RXD pin PD0 is the E strobe of LCD chip 1.
+* the statistics are dumped every MF_STATS_FRAMES rendered frames, right
+* after the render in the bus idle window, and once after a watchdog reset.
+*/
+#define MF_STATS_FRAMES      256  // power of 2
 #endif
 
 int main(void)
@@ -73,6 +86,7 @@ int main(void)
 
   setup();
   MF_InitFrameBuffer();
+  check_reset();
 
   sei();
 #ifdef __DEBUG_MODE__
@@ -82,48 +96,45 @@ int main(void)
 
   wdt_reset();
   welcome();
+  MF_InitCells();
   wdt_reset();
+#ifdef __DEBUG_MODE__
+  if(mfStats.wdtResets)
+  {
+    MF_PrintStats();
+  }
+#endif
   
   while(1)
   {
-    /*
-     * when PWO logic 'L' (data bus idle) Refreshes the display
-     */
-    //if((milliseconds & 0x200) && isDataBusIdle())
-    if(isDataBusIdle())
+    uint8_t poll = MF_Poll();
+
+    if(poll & MF_POLL_IDLE)
     {
-      if(MF_isValid())
-      {
-#ifdef __DEBUG_MODE__
-        lastActiveTime = milliseconds;
-#endif
-        MF_DisplayDigit();
-        MF_DisplayPunctuation();
-        MF_DisplayAnnunciator();
-        MF_InitFrameBuffer();
+      wdt_reset();
+    }
 #ifdef __DEBUG_MODE__
-        printf("lead time(ms) = [%u]\r\n",milliseconds-lastActiveTime);
-#endif
+    if(poll & MF_POLL_START)
+    {
+      lastActiveTime = milliseconds;
+    }
+    if(poll & MF_POLL_DONE)
+    {
+      mfStats.renderMs = milliseconds-lastActiveTime;
+      if(!(mfStats.rendered & (MF_STATS_FRAMES - 1)))
+      {
+        MF_PrintStats();
       }
-      wdt_reset();
     }
+#endif
   }
   return 0;
 }
 
 static void welcome(void)
 {
-  glcd_clear(0x00);
-  glcd_selectfont(lcd14_15bi_16x17, LCD_DOT_SET, FONT_ENGLISH,0);
-  glcd_gotoxy(0,8); glcd_puts_P("************");
+  MF_DrawTest();
 
-  glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,12);
-  glcd_gotoxy(4 ,24);
-  for(uint8_t i=0; i<12; i++)
-  {
-    glcd_putc(MF_ANNUNCIATOR_CHAR);
-  }
-  
   /*
    * Display check Puase roughly 500mS (0.5s)
    * the Interrupts routine will run without pausing.
@@ -137,11 +148,8 @@ static void welcome(void)
   }
   wdt_reset();
 
-  glcd_clear(0x00);
-  glcd_bitmap(hp52x32, 0,0,LCD_DOT_SET);
-  glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,1);
-  glcd_gotoxy(53,8);  glcd_puts_P("6060B    3-60V/0-60A 300W");
-  glcd_gotoxy(53,16); glcd_puts_P("SYSTEM DC ELECTRONIC LOAD");
+  // the next screen is staged with the panel off, it appears at once
+  MF_DrawLogo();
   
   /*
    * At start up, a momentary (1 second) welcome screen display
@@ -155,7 +163,119 @@ static void welcome(void)
     }
   }  
   wdt_reset();
-  glcd_clear(0x00);
+
+  // scroll the logo out, about half a second
+  for(uint8_t line=0; line<=LCD_BOTTOM; line++)
+  {
+    uint8_t start = milliseconds;
+
+    MF_ScrollLogo(line);
+    while((uint8_t)(milliseconds - start) < MF_SCROLL_MS);
+  }
+  wdt_reset();
+}
+
+/*
+* count watchdog resets
+*
+* the reset flags in MCUCSR are cleared here, so a later watchdog reset
+* can be told apart from a power on reset.
+*/
+static void check_reset(void)
+{
+  uint8_t flags = MCUCSR;
+
+  MCUCSR = 0;
+  if(flags & _BV(PORF))
+  {
+    wdtResets = 0;
+  }
+  if(flags & _BV(WDRF))
+  {
+    wdtResets++;
+  }
+  mfStats.wdtResets = wdtResets;
+}
+
+#ifdef __DEBUG_MODE__
+/*
+* dump the frame statistics over the uart
+*/
+static void MF_PrintStats(void)
+{
+  uint16_t overflow, period, idle;
+
+  // copy what the interrupts update, print with the interrupts enabled
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    overflow = mfRing.overflow;
+    period   = mfBus.period;
+    idle     = mfBus.idle;
+  }
+  printf_P(PSTR("frames  started:%u completed:%u rendered:%u skipped:%u blanked:%u\r\n"),
+         mfStats.started, mfStats.completed, mfStats.rendered, mfStats.skipped, mfStats.blanked);
+  printf_P(PSTR("lost    torn:%u rejected:%u replaced:%u overflow:%u\r\n"),
+         mfStats.torn, mfStats.rejected, mfStats.dropped, overflow);
+  printf_P(PSTR("bus     bytes:%u unknown:%u\r\n"), mfStats.bytes, mfStats.unknown);
+  printf_P(PSTR("system  wdt resets:%u render time(ms):%u\r\n"), mfStats.wdtResets, mfStats.renderMs);
+  printf_P(PSTR("timing  period:%u idle:%u step:%u (x%luns)\r\n"), period, idle, MF_STEP_COST(), MF_TICK_NS);
+}
+#endif
+
+/*
+* Timer1 time stamp (MF_TICK_NS units)
+*
+* milliseconds and the fraction of the millisecond in TCNT1, call with
+* interrupts disabled. the fraction is scaled from the TCNT1 high byte to
+* the same unit (1/16ms) and never reaches a full millisecond, so the
+* time stamp is monotonic. a compare match that is not serviced yet is
+* accounted for.
+*/
+static uint16_t timer1_ticks(void)
+{
+  uint16_t ms  = milliseconds;
+  uint16_t cnt = TCNT1;
+
+  if((TIFR & _BV(OCF1A)) && (cnt < TIMER1_TOP/2))
+  {
+    ms++;
+  }
+  return (ms << MF_TICK_SHIFT) | (((uint8_t)(cnt >> 8) * (uint8_t)MF_TICK_SCALE) >> 8);
+}
+
+uint16_t sched_now(void)
+{
+  uint16_t now;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    now = timer1_ticks();
+  }
+  return now;
+}
+
+// ticks left in the predicted bus idle window
+uint16_t sched_budget(void)
+{
+  uint16_t budget;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    budget = MF_IdleBudget(timer1_ticks());
+  }
+  return budget;
+}
+
+// idle window identifier, the time stamp of the last burst end
+uint16_t sched_window(void)
+{
+  uint16_t window;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    window = mfBus.end;
+  }
+  return window;
 }
 
 static void timer1_init(void)
@@ -164,7 +284,7 @@ static void timer1_init(void)
   TCCR1B =  _BV(WGM12) |   // CTC mode(mode:4)
             _BV(CS10);     // clkI/O/1 (no prescaler)
             
-  OCR1A  |=  15999;        //(0.001    / (1 / (16000000 / 1)) - 1)
+  OCR1A  =  TIMER1_TOP;    // (0.001 / (1 / (F_CPU / 1)) - 1)
   TIMSK  |= _BV(OCIE1A);
 }
 
@@ -205,145 +325,6 @@ static void setup(void)
   spi_init(SPI_MODE_0, SPI_LSB, SPI_INTERRUPT, SPI_SLAVE);
 }
 
-static void MF_InitFrameBuffer(void)
-{
-  memset(&tMF, 0, sizeof(tMF));
-}
-
-static uint8_t MF_isValid(void)
-{
-
-  if((tMF[MF_IDX_REGISTER_A].valid  == MF_DATA_VALID) &&
-     (tMF[MF_IDX_REGISTER_B].valid  == MF_DATA_VALID) &&
-     (tMF[MF_IDX_REGISTER_C].valid  == MF_DATA_VALID) &&
-     (tMF[MF_IDX_ANNUNCIATOR].valid == MF_DATA_VALID))
-  {
-    return MF_DATA_VALID;
-  }
-  return MF_DATA_INVALID;
-
-}
-
-// number or character
-static void MF_DisplayDigit(void)
-{
-  uint8_t data;
-
-  glcd_selectfont(lcd14_15bi_16x17, LCD_DOT_SET, FONT_ENGLISH,0);
-  glcd_gotoxy(0,8);
-  for(uint8_t i=0; i<MF_MAX_DIGIT; i+=2)
-  {
-    // even digit
-    data = ((tMF[MF_IDX_REGISTER_A].data[i/2] & 0xf0) >> 4)|
-            (tMF[MF_IDX_REGISTER_B].data[i/2] & 0x30)      |
-           ((tMF[MF_IDX_REGISTER_C].data[i/2] & 0x10) << 2);
-    glcd_putc(MF_DigitLookup(data));
-
-    // odd digit
-    data =  (tMF[MF_IDX_REGISTER_A].data[i/2] & 0x0f)      |
-           ((tMF[MF_IDX_REGISTER_B].data[i/2] & 0x03) << 4)|
-           ((tMF[MF_IDX_REGISTER_C].data[i/2] & 0x01) << 6);
-    glcd_putc(MF_DigitLookup(data));
-  }
-}
-
-// Punctuation ('.', ',', ':')
-static void MF_DisplayPunctuation(void)
-{
-  uint8_t data;
-
-  glcd_selectfont(hp6060b_punct, LCD_DOT_SET, FONT_ENGLISH,15);
-  glcd_gotoxy(14,16);
-  for(uint8_t i=0; i<MF_MAX_DIGIT; i+=2)
-  {
-    // even digit punctuation
-    data = (tMF[MF_IDX_REGISTER_B].data[i/2] & 0xc0);
-    glcd_putc(MF_PunctuationLookup(data));
-
-    // odd digit punctuation
-    data = (tMF[MF_IDX_REGISTER_B].data[i/2] & 0x0c);
-    glcd_putc(MF_PunctuationLookup(data));
-  }
-}
-
-static void MF_DisplayAnnunciator(void)
-{
-  uint16_t bitmask;
-
-  bitmask = (tMF[MF_IDX_ANNUNCIATOR].data[0] << 8) | (tMF[MF_IDX_ANNUNCIATOR].data[1]);
-
-  glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,12);
-  glcd_gotoxy(4 ,24);
-  for(uint8_t i=MF_MAX_DIGIT; i--;)
-  {
-    if(bitmask & _BV(i))
-    {
-      glcd_putc(MF_ANNUNCIATOR_CHAR);
-    }
-    else
-    {
-      glcd_putc(' ');
-    }
-  }
-}
-
-/*
-* Lookup table for non standard characters
-*/
-static uint8_t MF_DigitLookup(uint8_t data)
-{
-  if(data == 00) data = '*';   // '@' -> '*';
-  else if(data < 0x20)  data = data + '@';   // '@ABCDEFGHIJKLMNOPQRSTUVWXYZ'
-  else if(data == 0x2c) data = '<';    // should be a left pointing arrow
-  else if(data == 0x2e) data = '>';    // should be a right pointing arrow
-  else if(data == 0x3a) data = '*';    // should be the 14 segments lit
-  else if(data <  0x40) data = data;   // ';<=>?'
-  else if(data <  0x46) data = data - 'A' + 'a'; // 'abcde'
-//else if(data == 0x40) data = '/';    // should be a 90° counter clockwise rotated 'T'
-//else if(data == 0x46) data = '/';    // 46~4b this one and the 5 following should represent a hourglass
-//else if(data == 0x47) data = '/';
-//else if(data == 0x48) data = '/';
-//else if(data == 0x49) data = '/';
-//else if(data == 0x4a) data = '/';
-//else if(data == 0x4b) data = '/';
-//else if(data == 0x4c) data = '/';    // 'µ'
-//else if(data == 0x4d) data = '/';    // "not equal"
-//else if(data == 0x4e) data = '/';    // sigma sign
-//else if(data == 0x4f) data = '/';
-  else
-  {
-    data = '?'; //unknown
-  }
-  return data;
-}
-/*
-* Lookup table for Punctuation characters
-*/
-static uint8_t MF_PunctuationLookup(uint8_t data)
-{
-  switch(data)
-  {
-    case 0x40:        // even digits
-    case 0x04:        // odd digits
-         data = MF_PUNCT_DOT;
-         break;
-
-    case 0x80:
-    case 0x08:
-         data = MF_PUNCT_COLON;
-         break;
-
-    case 0xc0:
-    case 0x0c:
-         data = MF_PUNCT_COMMA;
-         break;
-
-    default:
-         data = MF_PUNCT_NONE;
-         break;
-  }
-  return data;
-}
 /**********************
  * Interrupt routines *
  **********************/
@@ -360,98 +341,58 @@ ISR(TIMER1_COMPA_vect)
 ISR(INT0_vect)
 {
   spi_disable();
+  MF_BusIdle(timer1_ticks());
 }
 /*
 * External interrupt 1(SYNC Any logical change)
 *
 * SYNC:used to enable the SPI when the SYNC line from the 6060B changes state
 * "1":command(ISA line), "0":data(INA line)
+* the first change after PWO went active is the start of a bus burst
 */
 ISR(INT1_vect)
 {
   if(isDataBusActive())
   {
     spi_enable();
+    if(!mfBus.active)
+    {
+      MF_BusActive(timer1_ticks());
+    }
   }
 }
 /*
 * SPI Serial Transfer Complete interrupt
 *
-* stores unprocessed data(Message Frame consists of 7 commands)
+* captures the raw bus byte and the SYNC level into mfRing,
+* all protocol interpretation is done by MF_Decode() in the main loop.
+* a byte that does not fit is dropped and counted in mfRing.overflow.
 *
-* idxCmd : current command index
-* szData : data Size(one or more, max 6 byte)
-* data   : command or data that corresponding to the command
+* SPDR is double buffered on reception only, so the byte must be read
+* before the next one is complete, 8 SCK periods. make isrcheck takes the
+* worst case cycles of this handler from main.lss with tools/isrcycles.awk
+* and fails when they are not below that byte time at SPI_SCK of the
+* Makefile, the bus clock measured on the 6060B. it is run by hand, the
+* script is not yet checked against an avr-gcc listing. keep the handler free of calls and loops, the check needs
+* straight line code. INT0, INT1 and the timer handlers can hold it off
+* as well, they are not in the check, so the handler alone has to stay far
+* below the byte time.
 */
 ISR(SPI_STC_vect)
 {
-  static uint8_t idxCmd = 0;
-  static uint8_t szData = 0;
-  uint8_t data;
+  uint8_t data = HAL_SPI_DATA();
+  uint8_t head = mfRing.head;
+  uint8_t next = (head + 1) & MF_RING_MASK;
 
-  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  if(next != mfRing.tail)
   {
-    data = SPDR;
-
-    if(isCommand())
-    {
-      /*
-       * if SYNC Logic High(1), command field in the message frame(from ISA)
-       */
-      switch(data)
-      {
-        case MF_REGISTER_A:
-             idxCmd = MF_IDX_REGISTER_A;
-             szData = MF_SZ_REGISTER_A;
-             break;
-
-        case MF_REGISTER_B:
-             idxCmd = MF_IDX_REGISTER_B;
-             szData = MF_SZ_REGISTER_B;
-             break;
-
-        case MF_REGISTER_C:
-             idxCmd = MF_IDX_REGISTER_C;
-             szData = MF_SZ_REGISTER_C;
-             break;
-
-        case MF_ANNUNCIATOR:
-             idxCmd = MF_IDX_ANNUNCIATOR;
-             szData = MF_SZ_ANNUNCIATOR;
-             break;
-
-        // below an unused command - ignored
-        case MF_START_MF:
-        case MF_UNCHECK_2E0:
-        case MF_DISPLAY_ONOFF:
-        default:
-             szData = 0;
-             break;
-      }
-      if(szData > 0)
-      {
-        tMF[idxCmd].cmd = data;
-        tMF[idxCmd].dsz = szData;
-      }
-    }
-    else
-    {
-      /*
-       * if SYNC Logic Low(0), one or more data that corresponding to the command(from INA)
-       * it depends on the previous "command" received
-       */
-      if(szData > 0)
-      {
-        // data are received in reverse order, we have to reorder them
-        tMF[idxCmd].data[szData-1] = data;
-        tMF[idxCmd].valid = MF_DATA_VALID;  // data are received.
-        szData--;
-      }
-      else
-      {
-        spi_disable();
-      }
-    }
+    mfRing.data[head] = data;
+    mfRing.sync[head] = isCommand();
+    mfRing.head = next;
+  }
+  else
+  {
+    mfRing.overflow++;
   }
 }
 
@@ -0,0 +1,449 @@
+/*
+ * $Id: render.c ssk  $
+ *
+ * HP 6060B display contents on the WG20232A, the cell compositor.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+#include <string.h>           // memcmp, memcpy, memset
+#include "hal.h"
+#include "sbn166g.h"
+#include "glcd.h"
+#include "hp6060b.h"
+#include "render.h"
+#include "fonts/allfonts.h"
+#include "bitmaps/allbitmaps.h"
+
+static uint8_t MF_DigitCode(const tMessageFrame* mf, uint8_t i);
+static uint8_t MF_PunctuationCode(const tMessageFrame* mf, uint8_t i);
+static uint8_t MF_AnnunciatorCode(const tMessageFrame* mf, uint8_t i);
+static uint16_t MF_CellKey(const tMessageFrame* mf, uint8_t row, uint8_t cell);
+static void MF_ComposeCell(uint8_t row, uint16_t key);
+static uint8_t MF_DigitLookup(uint8_t data);
+static uint8_t MF_PunctuationLookup(uint8_t data);
+
+// A/B/C/annunciator payload of the last rendered frame
+static uint8_t mfLastPayload[MF_SZ_PAYLOAD];
+static uint8_t mfLastValid = MF_DATA_INVALID;
+
+// per-cell record of what is on the LCD (MF_CellKey per row and cell)
+static uint16_t mfCell[MF_SZ_ROW][MF_MAX_DIGIT];
+
+// render job (MF_Render)
+static uint8_t  mfRenderJob;                      // current job (row, cell)
+static uint8_t  mfLine[MF_CELL_PITCH];            // line buffer, one page of a cell
+uint16_t        mfStepCost8 = MF_STEP_COST_INIT*8; // learned cost of a step (1/8 ticks)
+static uint16_t mfRenderWindow;                   // idle window of the last step (burst end)
+
+// main loop state (MF_Poll)
+static uint8_t  mfDisplayOn = 1;                  // LCD panel state (glcd_display)
+static const tMessageFrame* mfRendering = NULL;   // frame being rendered (MF_Render)
+
+/*
+* the display check screen, every digit and annunciator lit
+*/
+void MF_DrawTest(void)
+{
+  glcd_clear(0x00);
+  glcd_selectfont(lcd14_15bi_16x17, LCD_DOT_SET, FONT_ENGLISH,0);
+  glcd_gotoxy(0,8); glcd_puts_P("************");
+
+  glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,12);
+  glcd_gotoxy(4 ,24);
+  for(uint8_t i=0; i<12; i++)
+  {
+    glcd_putc(MF_ANNUNCIATOR_CHAR);
+  }
+}
+
+/*
+* the welcome screen, staged with the panel off so it appears at once
+*
+* the logo is written over the left columns as it is, straight from flash
+* and without reading the LCD back, only the columns right of it are
+* filled blank before the text goes in.
+*/
+void MF_DrawLogo(void)
+{
+  uint8_t width = pgm_read_byte(hp52x32);
+
+  glcd_display(0);
+  for(uint8_t page=0; page<LCD_Y_BYTES; page++)
+  {
+    glcd_write_run_P(0, page, hp52x32 + 2 + page*width, width);
+    glcd_fill_run(width, page, 0x00, LCD_X_BYTES - width);
+  }
+  glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,1);
+  glcd_gotoxy(53,8);  glcd_puts_P("6060B    3-60V/0-60A 300W");
+  glcd_gotoxy(53,16); glcd_puts_P("SYSTEM DC ELECTRONIC LOAD");
+  glcd_display(1);
+}
+
+/*
+* one line of the welcome screen scrolled out at the top, line 0 ~ 31
+*
+* the start line moves one line down, the screen moves up without any RAM
+* copy (glcd_scroll). the RAM line that leaves the top comes back at the
+* bottom row, so a page is cleared while it is the top page, before its
+* first line wraps around. after line 31 the panel is blank and the start
+* line is back at 0, the live screen is drawn as usual.
+*/
+void MF_ScrollLogo(uint8_t line)
+{
+  if(!(line & 7))
+  {
+    glcd_clearpage(line >> 3, 0x00);
+  }
+  glcd_scroll(line + 1);
+}
+
+/*
+* compare the frame payload against the last rendered frame
+*
+* returns non zero if the frame differs (or nothing was rendered yet),
+* the payload is then saved as the last rendered frame.
+*/
+uint8_t MF_isChanged(const tMessageFrame* mf)
+{
+  uint8_t changed = (mfLastValid != MF_DATA_VALID);
+  uint8_t* last   = mfLastPayload;
+
+  for(uint8_t i=0; i<MF_SZ_COMMAND; i++)
+  {
+    uint8_t dsz = mf[i].dsz;
+
+    if(memcmp(last, mf[i].data, dsz))
+    {
+      memcpy(last, mf[i].data, dsz);
+      changed = 1;
+    }
+    last += dsz;
+  }
+  mfLastValid = MF_DATA_VALID;
+
+  return changed;
+}
+
+/*
+* reset the per-cell record to a blank screen
+*
+* must follow a glcd_clear(0x00), every cell then shows ' ', no punctuation
+* and no annunciator, so only the cells that differ from blank are drawn.
+*/
+void MF_InitCells(void)
+{
+  for(uint8_t i=0; i<MF_MAX_DIGIT; i++)
+  {
+    mfCell[MF_ROW_UPPER][i]       = ' ';
+    mfCell[MF_ROW_LOWER][i]       = (MF_PUNCT_NONE << 8) | ' ';
+    mfCell[MF_ROW_ANNUNCIATOR][i] = ' ';
+  }
+  mfLastValid = MF_DATA_INVALID;
+}
+
+// number or character
+static uint8_t MF_DigitCode(const tMessageFrame* mf, uint8_t i)
+{
+  uint8_t data;
+
+  if(i & 1)
+  {
+    // odd digit
+    data =  (mf[MF_IDX_REGISTER_A].data[i/2] & 0x0f)      |
+           ((mf[MF_IDX_REGISTER_B].data[i/2] & 0x03) << 4)|
+           ((mf[MF_IDX_REGISTER_C].data[i/2] & 0x01) << 6);
+  }
+  else
+  {
+    // even digit
+    data = ((mf[MF_IDX_REGISTER_A].data[i/2] & 0xf0) >> 4)|
+            (mf[MF_IDX_REGISTER_B].data[i/2] & 0x30)      |
+           ((mf[MF_IDX_REGISTER_C].data[i/2] & 0x10) << 2);
+  }
+  return MF_DigitLookup(data);
+}
+
+// Punctuation ('.', ',', ':')
+static uint8_t MF_PunctuationCode(const tMessageFrame* mf, uint8_t i)
+{
+  uint8_t data;
+
+  if(i & 1)
+  {
+    // odd digit punctuation
+    data = (mf[MF_IDX_REGISTER_B].data[i/2] & 0x0c);
+  }
+  else
+  {
+    // even digit punctuation
+    data = (mf[MF_IDX_REGISTER_B].data[i/2] & 0xc0);
+  }
+  return MF_PunctuationLookup(data);
+}
+
+static uint8_t MF_AnnunciatorCode(const tMessageFrame* mf, uint8_t i)
+{
+  uint16_t bitmask;
+
+  bitmask = (mf[MF_IDX_ANNUNCIATOR].data[0] << 8) | (mf[MF_IDX_ANNUNCIATOR].data[1]);
+
+  // the top right annunciator is transmitted first, cell 0 is the highest bit
+  return (bitmask & _BV(MF_MAX_DIGIT-1-i)) ? MF_ANNUNCIATOR_CHAR : ' ';
+}
+
+/*
+* what a row of a cell shows, the character codes of its glyphs
+*/
+static uint16_t MF_CellKey(const tMessageFrame* mf, uint8_t row, uint8_t cell)
+{
+  switch(row)
+  {
+    case MF_ROW_UPPER:
+         return MF_DigitCode(mf, cell);
+
+    case MF_ROW_LOWER:
+         return (MF_PunctuationCode(mf, cell) << 8) | MF_DigitCode(mf, cell);
+
+    case MF_ROW_ANNUNCIATOR:
+    default:
+         return MF_AnnunciatorCode(mf, cell);
+  }
+}
+
+/*
+* compose a row of a cell into the line buffer
+*
+* the digit glyph columns OR the punctuation OR the annunciator pattern,
+* at their offsets in the cell (MF_DIGIT_X, MF_PUNCT_X, MF_ANNUNCIATOR_X).
+*/
+static void MF_ComposeCell(uint8_t row, uint16_t key)
+{
+  memset(mfLine, 0, sizeof(mfLine));
+
+  switch(row)
+  {
+    case MF_ROW_UPPER:
+    case MF_ROW_LOWER:
+         glcd_selectfont(lcd14_15bi_16x17, LCD_DOT_SET, FONT_ENGLISH,0);
+         glcd_glyphpage(key & 0xff, row - MF_ROW_UPPER, mfLine);
+         if(row == MF_ROW_LOWER)
+         {
+           glcd_selectfont(hp6060b_punct, LCD_DOT_SET, FONT_ENGLISH,15);
+           glcd_glyphpage(key >> 8, 0, mfLine + MF_PUNCT_X(0) - MF_DIGIT_X(0));
+         }
+         break;
+
+    case MF_ROW_ANNUNCIATOR:
+    default:
+         glcd_selectfont(system_5_5x7, LCD_DOT_SET, FONT_ENGLISH,12);
+         glcd_glyphpage(key, 0, mfLine + MF_ANNUNCIATOR_X(0) - MF_DIGIT_X(0));
+         break;
+  }
+}
+
+/*
+* start rendering a frame, from the first job
+*/
+void MF_RenderStart(void)
+{
+  mfRenderJob = 0;
+}
+
+/*
+* render the frame as a resumable job
+*
+* a job is one LCD page (row) of a cell, the rows are rendered top down and
+* every row left to right (MF_RENDER_JOBS). a changed cell row is composed
+* in the line buffer and streamed once (glcd_write_run), a step. rendering
+* stops as soon as PWO goes active or the next step does not fit into the
+* idle window predicted by the bus timing model, and resumes at the same
+* job in the next idle window.
+*
+* returns non zero when the whole frame is on the LCD.
+*/
+uint8_t MF_Render(const tMessageFrame* mf)
+{
+  while(mfRenderJob < MF_RENDER_JOBS)
+  {
+    uint8_t  row  = mfRenderJob / MF_MAX_DIGIT;
+    uint8_t  cell = mfRenderJob % MF_MAX_DIGIT;
+    uint16_t key  = MF_CellKey(mf, row, cell);
+    uint16_t start;
+
+    // nothing to draw for an unchanged cell
+    if(key == mfCell[row][cell])
+    {
+      mfRenderJob++;
+      continue;
+    }
+
+    if(!isDataBusIdle()) return 0;
+
+    // one step per idle window is always allowed, a window shorter
+    // than a step must not stall the rendering
+    if((sched_budget() < MF_STEP_COST()) && (mfRenderWindow == sched_window())) return 0;
+    mfRenderWindow = sched_window();
+
+    start = sched_now();
+    MF_ComposeCell(row, key);
+    glcd_write_run(MF_DIGIT_X(cell), MF_ROW_PAGE(row), mfLine, MF_CELL_PITCH);
+    mfCell[row][cell] = key;
+    mfRenderJob++;
+
+    // learn the cost of a step (moving average 1/8)
+    mfStepCost8 += (sched_now() - start) - (mfStepCost8 >> 3);
+  }
+  return 1;
+}
+
+/*
+* one pass of the main loop, shared by main.c and the host build
+*
+* rebuilds the message frame from the captured bus bytes, follows the
+* display on/off of the 6060B, takes the next frame while the bus is idle
+* and renders as much of it as fits into the predicted idle window.
+* nothing is rendered while the display is blanked, the 6060B keeps
+* retransmitting the same contents, a frame is redrawn only on change.
+*
+* returns MF_POLL_ flags of what happened in the pass.
+*/
+uint8_t MF_Poll(void)
+{
+  uint8_t poll = 0;
+
+  MF_Decode();
+
+  // follow the front panel display on/off, one command for all controllers
+  if((MF_isDisplayOn() != 0) != mfDisplayOn)
+  {
+    mfDisplayOn = !mfDisplayOn;
+    glcd_display(mfDisplayOn);
+  }
+
+  // when PWO logic 'L' (data bus idle) look for a new frame
+  if(!mfRendering && isDataBusIdle())
+  {
+    tMessageFrame* mf = MF_AcquireFrame();
+
+    poll |= MF_POLL_IDLE;
+    if(mf)
+    {
+      if(!mfDisplayOn)
+      {
+        mfStats.blanked++;
+        MF_ReleaseFrame();
+      }
+      else
+      if(MF_isChanged(mf))
+      {
+        mfRendering = mf;
+        MF_RenderStart();
+        poll |= MF_POLL_START;
+      }
+      else
+      {
+        mfStats.skipped++;
+        MF_ReleaseFrame();
+      }
+    }
+  }
+
+  if(mfRendering)
+  {
+    if(MF_Render(mfRendering))
+    {
+      mfRendering = NULL;
+      mfStats.rendered++;
+      MF_ReleaseFrame();
+      poll |= MF_POLL_DONE;
+    }
+    else
+    {
+      poll |= MF_POLL_BUSY;
+    }
+  }
+  return poll;
+}
+
+/*
+* Lookup table for non standard characters
+*
+* the 7 bit register code (A/B/C) indexes the character of lcd14_15bi_16x17,
+* one flash read for every code. 'f'..'r' are the 6060B specific glyphs.
+*/
+static const uint8_t MF_DigitTable[128] PROGMEM =
+{
+  '*', 'A', 'B', 'C', 'D', 'E', 'F', 'G',   // 00 00:'@' -> '*'
+  'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O',   // 08
+  'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W',   // 10
+  'X', 'Y', 'Z', '[', '\\', ']', '^', '_',   // 18
+  ' ', '!', '"', '#', '$', '%', '&', '\'',   // 20 20:' '..'?'
+  '(', ')', '*', '+', 'g', '-', 'h', '/',   // 28 2c:left arrow 2e:right arrow
+  '0', '1', '2', '3', '4', '5', '6', '7',   // 30
+  '8', '9', 'i', ';', '<', '=', '>', '?',   // 38 3a:the 14 segments lit
+  'f', 'a', 'b', 'c', 'd', 'e', 'j', 'k',   // 40 40:90° counter clockwise rotated 'T' 41:'abcde' 46:46~4b hourglass
+  'l', 'm', 'n', 'o', 'p', 'q', 'r', '?',   // 48 4c:'µ' 4d:not equal 4e:sigma sign 4f:unknown
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 50
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 58
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 60
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 68
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 70
+  '?', '?', '?', '?', '?', '?', '?', '?',   // 78
+};
+
+static uint8_t MF_DigitLookup(uint8_t data)
+{
+  return pgm_read_byte(&MF_DigitTable[data & 0x7f]);
+}
+/*
+* Lookup table for Punctuation characters
+*/
+static uint8_t MF_PunctuationLookup(uint8_t data)
+{
+  switch(data)
+  {
+    case 0x40:        // even digits
+    case 0x04:        // odd digits
+         data = MF_PUNCT_DOT;
+         break;
+
+    case 0x80:
+    case 0x08:
+         data = MF_PUNCT_COLON;
+         break;
+
+    case 0xc0:
+    case 0x0c:
+         data = MF_PUNCT_COMMA;
+         break;
+
+    default:
+         data = MF_PUNCT_NONE;
+         break;
+  }
+  return data;
+}
+/*
+ * EOF
+ */
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+/*
+ * $Id: render.h ssk  $
+ *
+ * HP 6060B display contents on the WG20232A, the cell compositor.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+#define MF_STEP_COST()    ((mfStepCost8 + 7) >> 3)   // ticks, rounded up
+
+// MF_Poll() flags
+#define MF_POLL_IDLE      0x01   // the bus was idle, a new frame was looked for
+#define MF_POLL_START     0x02   // a changed frame started rendering
+#define MF_POLL_DONE      0x04   // the frame being rendered is on the LCD
+#define MF_POLL_BUSY      0x08   // the frame being rendered waits for the next idle window
+
+extern uint16_t mfStepCost8;
+
+// function prototype
+extern void MF_InitCells(void);
+extern uint8_t MF_isChanged(const tMessageFrame* mf);
+extern void MF_RenderStart(void);
+extern uint8_t MF_Render(const tMessageFrame* mf);
+extern void MF_DrawTest(void);
+extern void MF_DrawLogo(void);
+extern void MF_ScrollLogo(uint8_t line);
+extern uint8_t MF_Poll(void);
+
+/*
+* render scheduler clock (MF_TICK_NS units), provided by the application,
+* Timer1 in main.c, a simulated clock in the host build
+*/
+extern uint16_t sched_now(void);
+extern uint16_t sched_budget(void);
+extern uint16_t sched_window(void);
+
+#endif
@@ -43,34 +43,62 @@
  * The hardware RESET is edge-sensitive. IT IS NOT LEVEL-SENSITIVE
  *
  */
-#include <avr/io.h>
-#include <avr/pgmspace.h>
-#include <util/delay.h>
+#include "hal.h"
+#include <string.h>           // memset
 #include "sbn166g.h"
 
 coordinates	 _glcd_coord;
 uint8_t _control_byte=0;
+uint8_t _glcd_start_line;      // RAM line shown on the top row of the display
+
+// controller side cursor, the column and page address of each chip
+#define LCD_CHIPS            3
+#define LCD_ADDR_UNKNOWN     0xff
+static uint8_t _chip_col[LCD_CHIPS];
+static uint8_t _chip_page[LCD_CHIPS];
+static const uint8_t _chip_start_x[LCD_CHIPS] = { LCD_CHIP1_START_X, LCD_CHIP2_START_X, LCD_CHIP3_START_X };
+static const uint8_t _chip_end_x[LCD_CHIPS]   = { LCD_CHIP2_START_X, LCD_CHIP3_START_X, LCD_X_BYTES };
+static volatile uint8_t* const _chip_port[LCD_CHIPS] = { &LCD_CHIP1_PORT, &LCD_CHIP2_PORT, &LCD_CHIP3_PORT };
+static const uint8_t _chip_mask[LCD_CHIPS]    = { _BV(LCD_CS1_PIN), _BV(LCD_CS2_PIN), _BV(LCD_CS3_PIN) };
+
+#ifdef LCD_SHADOW
+uint8_t _framebuffer[LCD_SHADOW_PAGES][LCD_SHADOW_COLS];  // RAM shadow of the LCD window
+static uint8_t* _glcd_shadow(uint8_t x, uint8_t page);
+#endif
 
 // Low level LCD Controller Interface Support function
 static void _glcd_command(const uint8_t data, uint8_t device);
 static void _glcd_data(const uint8_t data);
 static void _chip_select(uint8_t x);
 static void _chip_unselect(void);
+static uint8_t _chip_index(uint8_t x);
+static void _glcd_setaddress(uint8_t chip, uint8_t col, uint8_t page);
+static uint8_t _glcd_sync(void);
+static void _glcd_forget(void);
 static uint8_t _glcd_read_data(void);
+static void _glcd_write_byte(uint8_t data, uint8_t merge);
+static void _glcd_write_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len, uint8_t mode);
+static void _glcd_rmw_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len, int8_t shift, uint8_t mode);
+
+// _glcd_write_run, _glcd_rmw_run source modes
+#define RUN_RAM              0    // src is in RAM
+#define RUN_PGM              1    // src is in program memory
+#define RUN_FILL             2    // *src is repeated len times
+#define RUN_INVERT           4    // the bytes are inverted
 
 // routine to initialize the operation of the LCD display subsystem
 void glcd_init(void)
 {
   // output port
   //LCD_RST_DDR     |=  _BV(LCD_RST_PIN);
-  LCD_CONTROL_DDR |=  _BV(LCD_A0_PIN)  | _BV(LCD_RW_PIN);
-  LCD_CHIP1_DDR   |=  _BV(LCD_CS1_PIN);
-  LCD_CHIP2_DDR   |=  _BV(LCD_CS2_PIN);
-  LCD_CHIP3_DDR   |=  _BV(LCD_CS3_PIN);
+  HAL_SET(LCD_CONTROL_DDR, _BV(LCD_A0_PIN)  | _BV(LCD_RW_PIN));
+  HAL_SET(LCD_CHIP1_DDR, _BV(LCD_CS1_PIN));
+  HAL_SET(LCD_CHIP2_DDR, _BV(LCD_CS2_PIN));
+  HAL_SET(LCD_CHIP3_DDR, _BV(LCD_CS3_PIN));
 
   // lcd data high & low nibble port output
-  LCD_DATA_H_DDR  |=  0xf0;
-  LCD_DATA_L_DDR  |=  0x0f;
+  HAL_SET(LCD_DATA_H_DDR, 0xf0);
+  HAL_SET(LCD_DATA_L_DDR, 0x0f);
 
   // The hardware RESET is edge-sensitive. It is not level-sensitive. !!!
   // The value is relative to the RESET pulse edge.
@@ -84,14 +112,49 @@ void glcd_init(void)
 //  _glcd_command(LCD_RESET, LCD_CHIP_ALL);
 //  _delay_ms(5);
 
+  _glcd_forget();
   _glcd_command(LCD_STATIC_OFF, LCD_CHIP_ALL);
   _glcd_command(LCD_DUTY_32, LCD_CHIP_ALL);
   _glcd_command(LCD_SET_ADC_NOR, LCD_CHIP_ALL);
   _glcd_command(LCD_SET_RMW_END, LCD_CHIP_ALL);
   _glcd_command(LCD_START_LINE, LCD_CHIP_ALL);
+  _glcd_start_line = 0;
   _glcd_command(LCD_DISP_ON, LCD_CHIP_ALL);
 }
 
+/**
+ * turn the LCD panel on or off
+ *
+ * one command strobed into all three controllers at once,
+ * the display RAM is kept while the panel is off.
+ *
+ * to swap in a screen at once, draw it with the panel off and turn the
+ * panel on (see glcd_scroll).
+ */
+void glcd_display(uint8_t on)
+{
+  _glcd_command(on ? LCD_DISP_ON : LCD_DISP_OFF, LCD_CHIP_ALL);
+}
+
+/**
+ * scroll the display vertically
+ *
+ * @param line the RAM line shown on the top row, 0 ~ LCD_BOTTOM
+ *
+ * the start line register of the three controllers is set at once, the
+ * RAM is not touched (zero copy) and the rows wrap around: the display row
+ * r shows the RAM line (r + line) % 32. drawing keeps using RAM coordinates.
+ *
+ * the SBN166G holds exactly the 32 rows it shows (1/32 duty), there are
+ * no off-screen rows to stage a screen in, a line scrolled off the top
+ * comes back at the bottom row.
+ */
+void glcd_scroll(uint8_t line)
+{
+  _glcd_start_line = line & LCD_BOTTOM;
+  _glcd_command(LCD_START_LINE + _glcd_start_line, LCD_CHIP_ALL);
+}
+
 /**
  * Send LCD controller instruction command
  * Input: instruction to send to LCD controller
@@ -101,21 +164,21 @@ static void _glcd_command(const uint8_t data, uint8_t device)
 {
   uint8_t portmask;
 
-  LCD_CONTROL_PORT &= ~(_BV(LCD_A0_PIN));   // Low : Display Control data, High : Display data
-  LCD_CONTROL_PORT &= ~(_BV(LCD_RW_PIN));   // Low : Write Control signal, High : Read Control signal
+  HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));   // Low : Display Control data, High : Display data
+  HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));   // Low : Write Control signal, High : Read Control signal
 
   portmask = LCD_DATA_H_PORT & 0x0f;
-  LCD_DATA_H_PORT = portmask | (data & 0xf0);
+  HAL_OUT(LCD_DATA_H_PORT, portmask | (data & 0xf0));
 
   portmask = LCD_DATA_L_PORT & 0xf0;
-  LCD_DATA_L_PORT = portmask | (data & 0x0f);
+  HAL_OUT(LCD_DATA_L_PORT, portmask | (data & 0x0f));
 
-  //_delay_us(LCD_tAS);                   // tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
+  LCD_DELAY(LCD_tAS);                     // tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
 
-  if( device & LCD_CHIP_1 ) LCD_CHIP1_PORT |= _BV(LCD_CS1_PIN);
-  if( device & LCD_CHIP_2 ) LCD_CHIP2_PORT |= _BV(LCD_CS2_PIN);
-  if( device & LCD_CHIP_3 ) LCD_CHIP3_PORT |= _BV(LCD_CS3_PIN);
-  //_delay_us(LCD_tEWW);                  // Enable pulse width WRITE(minimum E hi pulse width)
+  if( device & LCD_CHIP_1 ) HAL_SET(LCD_CHIP1_PORT, _BV(LCD_CS1_PIN));
+  if( device & LCD_CHIP_2 ) HAL_SET(LCD_CHIP2_PORT, _BV(LCD_CS2_PIN));
+  if( device & LCD_CHIP_3 ) HAL_SET(LCD_CHIP3_PORT, _BV(LCD_CS3_PIN));
+  LCD_DELAY(LCD_tWRITE);                  // Enable pulse width WRITE(minimum E hi pulse width)
  _chip_unselect();
 }
 /**
@@ -126,29 +189,23 @@ static void _glcd_command(const uint8_t data, uint8_t device)
 static void _glcd_data(uint8_t data)
 {
   uint8_t portmask;
-  if(_glcd_coord.x == LCD_CHIP2_START_X)	// chip2 X-address = 0
-  {
-  	_glcd_command(LCD_SET_COL, LCD_CHIP_2);
-  }
-  else
-  if(_glcd_coord.x == LCD_CHIP3_START_X)	// chip2 X-address = 0
-  {
-  	_glcd_command(LCD_SET_COL, LCD_CHIP_3);
-  }
+  uint8_t chip = _glcd_sync();          // address the chip of the cursor
 
-  LCD_CONTROL_PORT |=  (_BV(LCD_A0_PIN));       // High: Display data, Low : Display Control data
-  LCD_CONTROL_PORT &= ~(_BV(LCD_RW_PIN));       // Low : Write Control signal,High: Read Control signal
+  HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));       // High: Display data, Low : Display Control data
+  HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));       // Low : Write Control signal,High: Read Control signal
 
   portmask = LCD_DATA_H_PORT & 0x0f;
-  LCD_DATA_H_PORT = portmask | (data & 0xf0);
+  HAL_OUT(LCD_DATA_H_PORT, portmask | (data & 0xf0));
 
   portmask = LCD_DATA_L_PORT & 0xf0;
-  LCD_DATA_L_PORT = portmask | (data & 0x0f);
-  //_delay_us(LCD_tAS);                       // tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
+  HAL_OUT(LCD_DATA_L_PORT, portmask | (data & 0x0f));
+  LCD_DELAY(LCD_tAS);                         // tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
 
   _chip_select(_glcd_coord.x);
-  //_delay_us(LCD_tEWW);                      // Enable pulse width WRITE(minimum E hi pulse width)
+  LCD_DELAY(LCD_tWRITE);                      // Enable pulse width WRITE(minimum E hi pulse width)
   _chip_unselect();
+
+  _chip_col[chip]++;                          // column auto-increment after a write
 }
 
 /* Specify a controller between  0 and LCD_RIGHT  */
@@ -157,26 +214,70 @@ static void _chip_select(uint8_t x)
   // Controller 1 area
   if( x < LCD_CHIP2_START_X)
   {
-  	LCD_CHIP1_PORT |= _BV(LCD_CS1_PIN);
+  	HAL_SET(LCD_CHIP1_PORT, _BV(LCD_CS1_PIN));
   }
   // Controller 2 area
   else
   if(x >= LCD_CHIP2_START_X && x < LCD_CHIP3_START_X)
   {
-    LCD_CHIP2_PORT |= _BV(LCD_CS2_PIN);
+    HAL_SET(LCD_CHIP2_PORT, _BV(LCD_CS2_PIN));
   }
   // Controller 3 area
   else
   if( x >=  LCD_CHIP3_START_X)
   {
-    LCD_CHIP3_PORT |= _BV(LCD_CS3_PIN);
+    HAL_SET(LCD_CHIP3_PORT, _BV(LCD_CS3_PIN));
   }
 }
 static void _chip_unselect(void)
 {
-  LCD_CHIP1_PORT &= ~_BV(LCD_CS1_PIN);
-  LCD_CHIP2_PORT &= ~_BV(LCD_CS2_PIN);
-  LCD_CHIP3_PORT &= ~_BV(LCD_CS3_PIN);
+  HAL_CLR(LCD_CHIP1_PORT, _BV(LCD_CS1_PIN));
+  HAL_CLR(LCD_CHIP2_PORT, _BV(LCD_CS2_PIN));
+  HAL_CLR(LCD_CHIP3_PORT, _BV(LCD_CS3_PIN));
+}
+/* the controller (0 ~ LCD_CHIPS-1) of the column x */
+static uint8_t _chip_index(uint8_t x)
+{
+  if(x < LCD_CHIP2_START_X) return 0;
+  if(x < LCD_CHIP3_START_X) return 1;
+  return 2;
+}
+/*
+ * Set the column and page address of a controller
+ * Input: chip index, column of the chip, page
+ * Returns: none
+ *
+ * only the addresses the controller does not already have are sent.
+*/
+static void _glcd_setaddress(uint8_t chip, uint8_t col, uint8_t page)
+{
+  if(_chip_page[chip] != page)
+  {
+    _glcd_command(LCD_SET_PAGE + page, _BV(chip));
+    _chip_page[chip] = page;
+  }
+  if(_chip_col[chip] != col)
+  {
+    _glcd_command(LCD_SET_COL + col, _BV(chip));
+    _chip_col[chip] = col;
+  }
+}
+/* bring the controller of the cursor to the cursor, returns its index */
+static uint8_t _glcd_sync(void)
+{
+  uint8_t chip = _chip_index(_glcd_coord.x);
+
+  _glcd_setaddress(chip, _glcd_coord.x - _chip_start_x[chip], _glcd_coord.y >> 3);
+  return chip;
+}
+/* the controller addresses are not known, the next access sends them */
+static void _glcd_forget(void)
+{
+  for(uint8_t chip=0; chip<LCD_CHIPS; chip++)
+  {
+    _chip_col[chip]  = LCD_ADDR_UNKNOWN;
+    _chip_page[chip] = LCD_ADDR_UNKNOWN;
+  }
 }
 /*
  * Send data byte to LCD controller (Pixel Aligment Write)
@@ -189,16 +290,13 @@ void glcd_offsetwrite(const uint8_t data)
   if(_glcd_coord.x > LCD_RIGHT)  return;    //  reached a end column
   if(_glcd_coord.y > LCD_BOTTOM) return;    //  reached a end row
 
-  uint8_t savedata;
   uint8_t yoffset  = _glcd_coord.y % 8;
   uint8_t changeYaxis;
 
   if(yoffset)
   {
     // first page
-    savedata =  _glcd_read_data();
-    savedata |= (data << yoffset);
-    _glcd_data(savedata);
+    _glcd_write_byte(data << yoffset, 1);
 
     // second page
     if((_glcd_coord.y+8) > LCD_BOTTOM)
@@ -207,19 +305,58 @@ void glcd_offsetwrite(const uint8_t data)
        return;
     }
     glcd_gotoxy(_glcd_coord.x, _glcd_coord.y+8);
-    savedata = _glcd_read_data();
-    savedata |= data >> (8-yoffset);
+    _glcd_write_byte(data >> (8-yoffset), 1);
 
-    _glcd_data(savedata);
     changeYaxis = _glcd_coord.y-8;
   }
   else
   {
-    _glcd_data(data);
+    _glcd_write_byte(data, 0);
     changeYaxis = _glcd_coord.y;
   }
   glcd_gotoxy(_glcd_coord.x+1, changeYaxis);
 }
+
+/*
+ * write a data byte at the cursor
+ * Input: data, merge non zero ORs data into the byte on the LCD
+ * Returns: none
+ *
+ * With LCD_SHADOW the byte is composed in the RAM shadow, no bus read is
+ * needed and an unchanged byte is not written at all. The cursor is not
+ * advanced, the callers move it with glcd_gotoxy.
+*/
+static void _glcd_write_byte(uint8_t data, uint8_t merge)
+{
+#ifdef LCD_SHADOW
+  uint8_t* shadow = _glcd_shadow(_glcd_coord.x, _glcd_coord.y/8);
+
+  if(shadow)
+  {
+    if(merge) data |= *shadow;
+    if(data == *shadow) return;             // unchanged, nothing to flush
+    *shadow = data;
+    _glcd_data(data);
+    return;
+  }
+#endif
+  if(merge) data |= _glcd_read_data();
+  _glcd_data(data);
+}
+
+#ifdef LCD_SHADOW
+/*
+ * the shadow byte of x and page
+ * Returns: NULL outside of the shadow window
+*/
+static uint8_t* _glcd_shadow(uint8_t x, uint8_t page)
+{
+  if((x    < LCD_SHADOW_X0)    || (x    >= LCD_SHADOW_X0    + LCD_SHADOW_COLS))  return NULL;
+  if((page < LCD_SHADOW_PAGE0) || (page >= LCD_SHADOW_PAGE0 + LCD_SHADOW_PAGES)) return NULL;
+
+  return &_framebuffer[page - LCD_SHADOW_PAGE0][x - LCD_SHADOW_X0];
+}
+#endif
  /**
  * Read a data byte from the given position
  *
@@ -232,32 +369,36 @@ static uint8_t _glcd_read_data(void)
 {
   uint8_t data;
 
+  _glcd_sync();                                      // address the chip of the cursor
+
+  // in the Read-Modify-Write mode a read does not increment the column,
+  // RMW END returns the column to where RMW START was issued.
   _glcd_command(LCD_SET_RMW_START, LCD_CHIP_ALL);    // Read-Modify-Write Start
 
-    LCD_DATA_H_DDR   &=  0x0f;           // high nibble input
-    LCD_DATA_L_DDR   &=  0xf0;           // low  nibble input
+    HAL_CLR(LCD_DATA_H_DDR, 0xf0);           // high nibble input
+    HAL_CLR(LCD_DATA_L_DDR, 0x0f);           // low  nibble input
 
-    LCD_CONTROL_PORT |=  _BV(LCD_A0_PIN);  // High : Display data,        Low : Display Control data
-    LCD_CONTROL_PORT |=  _BV(LCD_RW_PIN);  // High : Read Control signal, Low : Write Control signal
-#if (F_CPU >= 16000000)
-    _delay_us(LCD_tAS);                    // Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
-#endif
+    HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));  // High : Display data,        Low : Display Control data
+    HAL_SET(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));  // High : Read Control signal, Low : Write Control signal
+    LCD_DELAY(LCD_tAS);                    // Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
 
     // dummy read
     _chip_select(_glcd_coord.x);         // Enable signal (E) for the 68-type microcontroller
+    LCD_DELAY(LCD_tEWR);                 // Enable pulse width READ(minimum E hi pulse width)
     _chip_unselect();
 
     // read
     _chip_select(_glcd_coord.x);         // Enable signal (E) for the 68-type microcontroller
-   //_delay_us(LCD_tACC);                 // Data access time(E high to valid read data)
+    LCD_DELAY_READ(LCD_tACC);             // Data access time(E high to valid read data)
 
     // Get data from LCD data
-    data = (LCD_DATA_H_INPUT & 0xf0) | (LCD_DATA_L_INPUT & 0x0f);
+    data = (HAL_IN(LCD_DATA_H_INPUT) & 0xf0) | (HAL_IN(LCD_DATA_L_INPUT) & 0x0f);
 
+    LCD_DELAY(LCD_tEWR - LCD_tACC);      // the rest of the READ pulse width
     _chip_unselect();
 
-    LCD_DATA_H_DDR  |=  0xf0;           // output
-    LCD_DATA_L_DDR  |=  0x0f;           // output
+    HAL_SET(LCD_DATA_H_DDR, 0xf0);           // output
+    HAL_SET(LCD_DATA_L_DDR, 0x0f);           // output
 
   _glcd_command(LCD_SET_RMW_END, LCD_CHIP_ALL);     // Read-Modify-Write END
 
@@ -274,6 +415,10 @@ static uint8_t _glcd_read_data(void)
  * is the upper left corner.
  * Requests to set pixels outside the range of the display will be ignored.
  *
+ * No command is sent here. The column and page of every controller are
+ * tracked (including the column auto-increment after a data write), and
+ * the next data read or write sends only the addresses that differ.
+ *
  * @note for Non-Framebuffer
  *
 */
@@ -282,33 +427,9 @@ void glcd_gotoxy(uint8_t x,  uint8_t y)
   if(x > LCD_RIGHT)  return;      //  reached a end column
   if(y > LCD_BOTTOM) return;      //  reached a end row
 
-  uint8_t device = 0;
-
-  // save new coordinates
+  // save new coordinates, the controller is addressed by the next access
   _glcd_coord.x = x;
   _glcd_coord.y = y;
-
-  y >>= 3;     // page coordinate of the cursor (0 ~ LCD_Y_BYTES)
-
-  if(x < LCD_CHIP2_START_X)                          // 0 ~ LCD_CHIP2_START_X - 1 (Controller 1 area)
-  {
-  	device = LCD_CHIP_1;
-  }
-  else
-  if((x >= LCD_CHIP2_START_X) && (x < LCD_CHIP3_START_X)) // LCD_CHIP2_START_X ~ LCD_CHIP3_START_X - 1 (Controller 2 area)
-  {
-    device = LCD_CHIP_2;
-    x -= LCD_CHIP2_START_X;
-  }
-  else
-  if( x >=  LCD_CHIP3_START_X)                        // LCD_CHIP3_START_X ~ LCD_RIGHT Controller 3 area)
-  {
-    device = LCD_CHIP_3;
-    x -= LCD_CHIP3_START_X;
-  }
-
-  _glcd_command(LCD_SET_COL  + x, device);
-  _glcd_command(LCD_SET_PAGE + y, LCD_CHIP_ALL);
 }
 /**
  * set pixel at x,y to the given color
@@ -352,33 +473,379 @@ void glcd_gotoxy(uint8_t x,  uint8_t y)
 //  }
 //}
 
-// clear screen
+/**
+ * clear screen
+ *
+ * @see glcd_clearpage
+ */
 void glcd_clear(uint8_t fillchar)
+{
+  for(uint8_t page=LCD_Y_BYTES; page--;)
+  {
+    glcd_clearpage(page, fillchar);
+  }
+}
+
+/**
+ * fill one page of the screen
+ *
+ * @param page the page, a value from 0 to LCD_Y_BYTES-1
+ * @param fillchar the byte written to every column
+ *
+ * the three controllers share the data bus, so the fill byte is strobed
+ * into all of them together for the columns they have in common
+ * (LCD_CHIP1_MAX_COL, the narrowest chips). only the remaining columns
+ * of the wider CHIP2 are written on their own.
+ */
+#define LCD_CHIP2_COLS       (LCD_CHIP3_START_X - LCD_CHIP2_START_X)   // 80 columns
+
+void glcd_clearpage(uint8_t page, uint8_t fillchar)
 {
   uint8_t portmask;
 
-  for(uint8_t page=LCD_Y_BYTES; page--;)
+  if(page >= LCD_Y_BYTES) return;   //  reached a end row
+
+#ifdef LCD_SHADOW
+  if((page >= LCD_SHADOW_PAGE0) && (page < LCD_SHADOW_PAGE0 + LCD_SHADOW_PAGES))
+  {
+    memset(_framebuffer[page - LCD_SHADOW_PAGE0], fillchar, LCD_SHADOW_COLS);
+  }
+#endif
+
+  _glcd_command(LCD_SET_PAGE+page,LCD_CHIP_ALL);
+  _glcd_command(LCD_SET_COL,LCD_CHIP_ALL);
+
+  HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));  // High : Display data,        Low : Display Control data
+  HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));  // Low : Write Control signal, High : Read Control signal
+
+  // the fill byte does not change, drive the data bus once per page
+  portmask = LCD_DATA_H_PORT & 0x0f;
+  HAL_OUT(LCD_DATA_H_PORT, portmask | (fillchar & 0xf0));
+
+  portmask = LCD_DATA_L_PORT & 0xf0;
+  HAL_OUT(LCD_DATA_L_PORT, portmask | (fillchar & 0x0f));
+  LCD_DELAY(LCD_tAS);                      // Address setup time
+
+  // broadcast, all controllers at once
+  for(uint8_t x=LCD_CHIP1_MAX_COL; x--;)
+  {
+    HAL_SET(LCD_CHIP1_PORT, _BV(LCD_CS1_PIN));
+    HAL_SET(LCD_CHIP2_PORT, _BV(LCD_CS2_PIN));
+    HAL_SET(LCD_CHIP3_PORT, _BV(LCD_CS3_PIN));
+    LCD_DELAY(LCD_tWRITE);                 // Enable pulse width WRITE, from the last chip enabled
+    _chip_unselect();
+  }
+
+  // the rest of CHIP2
+  for(uint8_t x=LCD_CHIP2_COLS-LCD_CHIP1_MAX_COL; x--;)
+  {
+    HAL_SET(LCD_CHIP2_PORT, _BV(LCD_CS2_PIN));
+    LCD_DELAY(LCD_tWRITE);                 // Enable pulse width WRITE
+    _chip_unselect();
+  }
+  _glcd_forget();
+}
+/*
+ * the next source byte of a run
+ * Input: source pointer (advanced), RUN_ mode
+ * Returns: data byte
+*/
+static inline uint8_t _glcd_fetch(const uint8_t** src, uint8_t mode)
+{
+  uint8_t data;
+
+  if(mode & RUN_PGM)
+  {
+    data = pgm_read_byte((*src)++);
+  }
+  else
+  if(mode & RUN_FILL)
+  {
+    data = **src;
+  }
+  else
+  {
+    data = *(*src)++;
+  }
+  if(mode & RUN_INVERT) data = ~data;
+
+  return data;
+}
+
+/**
+ * write a run of bytes into one page
+ *
+ * @param x the first column, a value from 0 to LCD_RIGHT
+ * @param page the page, a value from 0 to LCD_Y_BYTES-1
+ * @param src a pointer to the data
+ * @param len the number of bytes, clipped at LCD_RIGHT
+ * @param mode RUN_RAM, RUN_PGM or RUN_FILL, RUN_INVERT
+ *
+ * The run is split at the chip boundaries once. For every chip segment the
+ * column/page address and A0/RW are set once, then the bytes are streamed
+ * with the column auto-increment of the controller, one enable strobe each.
+ * The cursor is left behind the run, at LCD_RIGHT if the run reaches it.
+ */
+static void _glcd_write_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len, uint8_t mode)
+{
+  if(x > LCD_RIGHT)        return;  //  reached a end column
+  if(page >= LCD_Y_BYTES)  return;  //  reached a end row
+
+  if(len > LCD_X_BYTES - x) len = LCD_X_BYTES - x;
+
+  while(len)
+  {
+    uint8_t chip   = _chip_index(x);   // the chip segment the run starts in
+    uint8_t base   = _chip_start_x[chip];
+    uint8_t count  = _chip_end_x[chip] - x;
+    volatile uint8_t* csport = _chip_port[chip];
+    uint8_t csmask = _chip_mask[chip];
+    uint8_t portmask;
+#ifdef LCD_SHADOW
+    uint8_t resync = 0;               // the controller column is behind x
+#endif
+
+    if(count > len) count = len;
+    len -= count;
+
+    _glcd_setaddress(chip, x - base, page);
+
+    HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));  // High : Display data,        Low : Display Control data
+    HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));  // Low : Write Control signal, High : Read Control signal
+    LCD_DELAY(LCD_tAS);                      // Address setup time
+
+    for(; count--; x++)
+    {
+      uint8_t data = _glcd_fetch(&src, mode);
+
+#ifdef LCD_SHADOW
+      uint8_t* shadow = _glcd_shadow(x, page);
+      if(shadow)
+      {
+        if(*shadow == data)
+        {
+          // unchanged, skip it and move the controller column later
+          resync = 1;
+          continue;
+        }
+        *shadow = data;
+      }
+      if(resync)
+      {
+        resync = 0;
+        _glcd_setaddress(chip, x - base, page);
+        HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));
+        HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));
+      }
+#endif
+      portmask = LCD_DATA_H_PORT & 0x0f;
+      HAL_OUT(LCD_DATA_H_PORT, portmask | (data & 0xf0));
+
+      portmask = LCD_DATA_L_PORT & 0xf0;
+      HAL_OUT(LCD_DATA_L_PORT, portmask | (data & 0x0f));
+
+      HAL_SET(*csport, csmask);                    // Enable signal (E) for the 68-type microcontroller
+      LCD_DELAY(LCD_tWRITE);                 // Enable pulse width WRITE
+      HAL_CLR(*csport, csmask);
+      _chip_col[chip] = x - base + 1;        // column auto-increment
+    }
+  }
+
+  // the cursor follows the run
+  _glcd_coord.x = (x > LCD_RIGHT) ? LCD_RIGHT : x;
+  _glcd_coord.y = page * 8;
+}
+
+/**
+ * write a run of bytes from RAM into one page
+ *
+ * @see _glcd_write_run
+ */
+void glcd_write_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len)
+{
+  _glcd_write_run(x, page, src, len, RUN_RAM);
+}
+
+/**
+ * write a run of bytes from program memory into one page
+ *
+ * @see _glcd_write_run
+ */
+void glcd_write_run_P(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len)
+{
+  _glcd_write_run(x, page, src, len, RUN_PGM);
+}
+
+/**
+ * fill a run of columns of one page with the same byte
+ *
+ * @see _glcd_write_run
+ */
+void glcd_fill_run(uint8_t x, uint8_t page, uint8_t data, uint8_t len)
+{
+  _glcd_write_run(x, page, &data, len, RUN_FILL);
+}
+
+/**
+ * OR a run of bytes into one page with a read-modify-write strip
+ *
+ * @param x the first column, a value from 0 to LCD_RIGHT
+ * @param page the page, a value from 0 to LCD_Y_BYTES-1
+ * @param src a pointer to the data
+ * @param len the number of bytes, clipped at LCD_RIGHT
+ * @param shift >0 shifts the bytes left (down), <0 right (up)
+ * @param mode RUN_RAM or RUN_PGM, RUN_INVERT
+ *
+ * The Read-Modify-Write mode is entered once per chip segment, then every
+ * column is read and written back. In this mode a read does not advance
+ * the column and a write does, so the strip walks the columns without any
+ * address command. RMW END returns the column to where the strip started.
+ *
+ * The output latch is loaded by a read only (SBN1661G data sheet v6.7, 8.2
+ * Read Display Data): after the address and after every write it still
+ * holds an older column, so every column takes a dummy read, a read and a
+ * write (Fig. 18). A column of the shadow is not read at all.
+ */
+static void _glcd_rmw_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len, int8_t shift, uint8_t mode)
+{
+  if(x > LCD_RIGHT)        return;  //  reached a end column
+  if(page >= LCD_Y_BYTES)  return;  //  reached a end row
+
+  if(len > LCD_X_BYTES - x) len = LCD_X_BYTES - x;
+
+  while(len)
   {
-  	_glcd_command(LCD_SET_PAGE+page,LCD_CHIP_ALL);
-  	_glcd_command(LCD_SET_COL,LCD_CHIP_ALL);
+    uint8_t chip   = _chip_index(x);   // the chip segment the run starts in
+    uint8_t base   = _chip_start_x[chip];
+    uint8_t count  = _chip_end_x[chip] - x;
+    volatile uint8_t* csport = _chip_port[chip];
+    uint8_t csmask = _chip_mask[chip];
+    uint8_t portmask;
+
+    if(count > len) count = len;
+    len -= count;
 
-    LCD_CONTROL_PORT |=  (_BV(LCD_A0_PIN));  // High : Display data,        Low : Display Control data
-    LCD_CONTROL_PORT &= ~(_BV(LCD_RW_PIN));  // Low : Write Control signal, High : Read Control signal
+    _glcd_setaddress(chip, x - base, page);
+    _glcd_command(LCD_SET_RMW_START, _BV(chip));    // Read-Modify-Write Start
 
-    for(uint8_t x=LCD_X_BYTES; x--;)
+    HAL_SET(LCD_CONTROL_PORT, _BV(LCD_A0_PIN));  // High : Display data,        Low : Display Control data
+
+    for(; count--; x++)
     {
-      _chip_select(x);
+      uint8_t data = _glcd_fetch(&src, mode);
+      uint8_t old;
 
-       portmask = LCD_DATA_H_PORT & 0x0f;
-       LCD_DATA_H_PORT = portmask | (fillchar & 0xf0);
+      data = (shift >= 0) ? (data << shift) : (data >> -shift);
 
-       portmask = LCD_DATA_L_PORT & 0xf0;
-       LCD_DATA_L_PORT = portmask | (fillchar & 0x0f);
+#ifdef LCD_SHADOW
+      uint8_t* shadow = _glcd_shadow(x, page);
+      if(shadow)
+      {
+        old = *shadow;
+      }
+      else
+#endif
+      {
+        HAL_CLR(LCD_DATA_H_DDR, 0xf0);         // high nibble input
+        HAL_CLR(LCD_DATA_L_DDR, 0x0f);         // low  nibble input
+        HAL_SET(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));  // High : Read Control signal, Low : Write Control signal
+        LCD_DELAY(LCD_tAS);                // Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
+
+        // dummy read, loads the latch from the column
+        HAL_SET(*csport, csmask);
+        LCD_DELAY(LCD_tEWR);               // Enable pulse width READ
+        HAL_CLR(*csport, csmask);
+
+        // read, the column does not advance
+        HAL_SET(*csport, csmask);
+        LCD_DELAY_READ(LCD_tACC);           // Data access time
+        old = (HAL_IN(LCD_DATA_H_INPUT) & 0xf0) | (HAL_IN(LCD_DATA_L_INPUT) & 0x0f);
+        LCD_DELAY(LCD_tEWR - LCD_tACC);
+        HAL_CLR(*csport, csmask);
+      }
+      data |= old;
+#ifdef LCD_SHADOW
+      if(shadow) *shadow = data;
+#endif
+
+      // write, the column advances
+      HAL_CLR(LCD_CONTROL_PORT, _BV(LCD_RW_PIN));
+      HAL_SET(LCD_DATA_H_DDR, 0xf0);           // output
+      HAL_SET(LCD_DATA_L_DDR, 0x0f);           // output
 
-      _chip_unselect();
+      portmask = LCD_DATA_H_PORT & 0x0f;
+      HAL_OUT(LCD_DATA_H_PORT, portmask | (data & 0xf0));
+
+      portmask = LCD_DATA_L_PORT & 0xf0;
+      HAL_OUT(LCD_DATA_L_PORT, portmask | (data & 0x0f));
+      LCD_DELAY(LCD_tAS);
+
+      HAL_SET(*csport, csmask);                  // Enable signal (E) for the 68-type microcontroller
+      LCD_DELAY(LCD_tWRITE);               // Enable pulse width WRITE
+      HAL_CLR(*csport, csmask);
     }
+
+    HAL_SET(LCD_DATA_H_DDR, 0xf0);              // output
+    HAL_SET(LCD_DATA_L_DDR, 0x0f);              // output
+    _glcd_command(LCD_SET_RMW_END, _BV(chip));      // Read-Modify-Write END, back to the start column
   }
 }
+
+/*
+ * write a run of bytes at x,y (Pixel Aligment Write)
+ * Input: x, y, source, length, RUN_ mode
+ * Returns: none
+ *
+ * a page aligned run is streamed, an unaligned one is ORed into the two
+ * pages it covers with one read-modify-write strip each, the same result
+ * as glcd_offsetwrite() byte by byte. The cursor is left behind the run,
+ * at LCD_RIGHT if the run reaches it, on both paths.
+*/
+static void _glcd_offsetwrite_run(uint8_t x, uint8_t y, const uint8_t* src, uint8_t len, uint8_t mode)
+{
+  if(x > LCD_RIGHT)  return;    //  reached a end column
+  if(y > LCD_BOTTOM) return;    //  reached a end row
+
+  uint8_t yoffset = y % 8;
+
+  if(!yoffset)
+  {
+    _glcd_write_run(x, y/8, src, len, mode);
+    return;
+  }
+
+  _glcd_rmw_run(x, y/8, src, len, yoffset, mode);
+  if((y+8) <= LCD_BOTTOM)
+  {
+    _glcd_rmw_run(x, y/8+1, src, len, yoffset-8, mode);
+  }
+
+  // the cursor follows the run
+  glcd_gotoxy((x+len > LCD_RIGHT) ? LCD_RIGHT : x+len, y);
+}
+
+/**
+ * write a run of bytes from RAM at x,y
+ *
+ * @param color LCD_DOT_XOR inverts the bytes
+ * @see _glcd_offsetwrite_run
+ */
+void glcd_offsetwrite_run(uint8_t x, uint8_t y, const uint8_t* src, uint8_t len, uint8_t color)
+{
+  _glcd_offsetwrite_run(x, y, src, len, (color == LCD_DOT_XOR) ? RUN_INVERT : RUN_RAM);
+}
+
+/**
+ * write a run of bytes from program memory at x,y
+ *
+ * @param color LCD_DOT_XOR inverts the bytes
+ * @see _glcd_offsetwrite_run
+ */
+void glcd_offsetwrite_run_P(uint8_t x, uint8_t y, const uint8_t* src, uint8_t len, uint8_t color)
+{
+  _glcd_offsetwrite_run(x, y, src, len, RUN_PGM | ((color == LCD_DOT_XOR) ? RUN_INVERT : 0));
+}
+
 /**
  * Draw a glcd bitmap image
  *
@@ -402,6 +869,17 @@ void glcd_bitmap(const uint8_t* bitmap, uint8_t x, uint8_t y,  const uint8_t col
 
   height /= 8;
 
+  // stream the pages as runs, read-modify-write strips if unaligned
+  if(color == LCD_DOT_SET)
+  {
+    for(uint8_t page=0; (page<height) && (y + page*8 <= LCD_BOTTOM); page++)
+    {
+      glcd_offsetwrite_run_P(x, y + page*8, bitmap, width, color);
+      bitmap += width;
+    }
+    return;
+  }
+
   for(uint8_t page=0; page<height; page++)
   {
     glcd_gotoxy(x, y + (page*8) );
@@ -93,17 +93,73 @@
 #define LCD_X_BYTES		    (LCD_RIGHT + 1)
 #define LCD_Y_BYTES		    (LCD_BOTTOM + 1) / 8 // The number of Page (4page x 8bit = 32 pixels)
 
+/*
+ * RAM shadow of the LCD (-DLCD_SHADOW)
+ *
+ * drawing is composed in RAM instead of reading the LCD back, and only
+ * the bytes that change are written. the whole screen takes 808 bytes,
+ * too much for the 1KB SRAM of the ATmega8, so the shadow covers a window
+ * of columns and pages, outside of it the LCD is read back as before.
+ * the default window is the top page of the digits (202 bytes), main.c
+ * checks the window against the SRAM left by the other static buffers.
+ *
+ * skipping an unchanged byte costs an address command to resync the
+ * column at the next changed one (_glcd_write_run). on the host capture
+ * host/test/frames.cap the default window takes the data writes from 1172
+ * to 991 and the commands from 54 to 98.
+ */
+#ifdef LCD_SHADOW
+#ifndef LCD_SHADOW_X0
+#define LCD_SHADOW_X0        0            // the first column of the window
+#endif
+#ifndef LCD_SHADOW_COLS
+#define LCD_SHADOW_COLS      LCD_X_BYTES  // the number of columns of the window
+#endif
+#ifndef LCD_SHADOW_PAGE0
+#define LCD_SHADOW_PAGE0     1            // the first page of the window
+#endif
+#ifndef LCD_SHADOW_PAGES
+#define LCD_SHADOW_PAGES     1            // the number of pages of the window
+#endif
+#if (LCD_SHADOW_X0 + LCD_SHADOW_COLS > LCD_X_BYTES) || (LCD_SHADOW_PAGE0 + LCD_SHADOW_PAGES > (LCD_BOTTOM + 1) / 8)
+#error "LCD_SHADOW window is out of the screen"
+#endif
+#define LCD_SHADOW_BYTES     (LCD_SHADOW_COLS * LCD_SHADOW_PAGES)
+#else
+#define LCD_SHADOW_BYTES     0
+#endif
+
 // Dot Color modes
 #define LCD_DOT_CLR          0
 #define LCD_DOT_SET          1
 #define LCD_DOT_XOR          2
 
 // AC timing for interface with a 68-type microcontroller at VDD=5 volts(unit:nano second)
-#define LCD_tAS              0.02 // 20  tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
-#define LCD_tDS              0.08 // 80  Data setup time (Write data lines setup to dropping E)
-#define LCD_tACC             0.90 // 90  Data access time(E high to valid read data)
-#define LCD_tEWR             0.10 // 200 Enable pulse width READ(minimum E hi pulse width)
-#define LCD_tEWW             0.08 // 160 Enable pulse width WRITE(minimum E hi pulse width)
+#define LCD_tAS              20   // tAS1,2:Address setup time with respect to R/W,C/S,C/D (ctrl line changes to E high)
+#define LCD_tDS              80   // Data setup time (Write data lines setup to dropping E)
+#define LCD_tACC             90   // Data access time(E high to valid read data)
+#define LCD_tEWR             200  // Enable pulse width READ(minimum E hi pulse width)
+#define LCD_tEWW             160  // Enable pulse width WRITE(minimum E hi pulse width)
+
+// the data bus is driven before E rises, so the E high time of a write covers the data setup too
+#define LCD_tWRITE           ((LCD_tEWW > LCD_tDS) ? LCD_tEWW : LCD_tDS)
+
+/*
+ * bus timing in CPU cycles, derived from F_CPU at compile time
+ *
+ * LCD_CYCLES rounds a time up to whole cycles. LCD_DELAY waits for it after
+ * a bus edge, less the cycle of the instruction that follows the edge, so
+ * the delay is only as long as the spec needs at the F_CPU of the build
+ * (nothing at all for tAS up to 50MHz).
+ *
+ * LCD_DELAY_READ waits from E high to the PINx read of the data. the input
+ * synchronizer of the AVR samples a pin 0.5 to 1.5 cycles late, so the
+ * time is rounded up and LCD_SYNC_CYCLES is added instead of subtracted.
+ */
+#define LCD_SYNC_CYCLES      2    // AVR input synchronizer latency, 1.5 cycles rounded up
+#define LCD_CYCLES(ns)       (((ns) * (F_CPU / 1000UL) + 999999UL) / 1000000UL)
+#define LCD_DELAY(ns)        HAL_DELAY_CYCLES((LCD_CYCLES(ns) > 1) ? LCD_CYCLES(ns) - 1 : 0)
+#define LCD_DELAY_READ(ns)   HAL_DELAY_CYCLES(LCD_CYCLES(ns) + LCD_SYNC_CYCLES)
 
 typedef struct
 {
@@ -112,12 +168,24 @@ typedef struct
 } coordinates;
 
 extern coordinates	_glcd_coord;
+extern uint8_t _glcd_start_line;
+#ifdef LCD_SHADOW
+extern uint8_t _framebuffer[LCD_SHADOW_PAGES][LCD_SHADOW_COLS];
+#endif
 
 // function prototype
 extern void glcd_init(void);
 extern void glcd_clear(uint8_t fillchar);
+extern void glcd_clearpage(uint8_t page, uint8_t fillchar);
+extern void glcd_display(uint8_t on);
+extern void glcd_scroll(uint8_t line);
 extern void glcd_gotoxy(uint8_t x,  uint8_t y);
 extern void glcd_offsetwrite(uint8_t data);
+extern void glcd_write_run(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len);
+extern void glcd_write_run_P(uint8_t x, uint8_t page, const uint8_t* src, uint8_t len);
+extern void glcd_fill_run(uint8_t x, uint8_t page, uint8_t data, uint8_t len);
+extern void glcd_offsetwrite_run(uint8_t x, uint8_t y, const uint8_t* src, uint8_t len, uint8_t color);
+extern void glcd_offsetwrite_run_P(uint8_t x, uint8_t y, const uint8_t* src, uint8_t len, uint8_t color);
 extern void glcd_bitmap(const uint8_t* bitmap, uint8_t x, uint8_t y,  const uint8_t color);
 #endif
 /*
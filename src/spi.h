@@ -30,7 +30,7 @@
 */
  
 
-#include <avr/io.h>
+#include "hal.h"
 
 #define SPI_PORT           PORTB
 #define SPI_DDR            DDRB
@@ -103,8 +103,8 @@
 #define SPI_MSTR_CLK8      0x05 // chip Fosc/8 
 #define SPI_MSTR_CLK32     0x06 // chip Fosc/32
 
-#define spi_enable()       SPCR |=  _BV(SPE)
-#define spi_disable()      SPCR &= ~_BV(SPE)
+#define spi_enable()       HAL_SET(SPCR, _BV(SPE))
+#define spi_disable()      HAL_CLR(SPCR, _BV(SPE))
 
 // setup spi
 extern void spi_init(uint8_t mode,     // timing mode SPI_MODE[0-4]
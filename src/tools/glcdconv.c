@@ -0,0 +1,577 @@
+/*
+ * $Id: glcdconv.c 2019-12-20 ssk $
+ *
+ * Host side font and bitmap compiler for the GLCD library.
+ * Compiles BDF fonts and monochrome BMP images into PROGMEM tables.
+ *
+ * MIT License
+ *
+ * Copyright (c) 2019 ssk.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+*/
+
+/**
+ *
+ * usage: glcdconv [-n name] [-f first] [-l last] [-o] [-p] [-i] file.bdf|file.bmp|file.h > file.h
+ *
+ *   -n name   array name, default the file name
+ *   -f first  first character of a font (default 32)
+ *   -l last   last character of a font (default 127)
+ *   -o        variable width font with an offset table (FONT_OFFSET_TABLE)
+ *   -p        PackBits compressed glyphs (FONT_PACKBITS), with an offset table
+ *   -i        also emit the inverted variant, <name>_inv
+ *
+ * The glyph data is written in the order the LCD bus consumes it: a glyph
+ * page after page (top down), every page column after column (left to
+ * right), bit 0 at the top. This is the order glcd_offsetwrite_run_P and
+ * glcd_glyphpage stream a glyph page, a straight pgm_read_byte sequence.
+ * The inverted variant lets LCD_DOT_XOR text use a plain LCD_DOT_SET font.
+ * A font header of this library (file.h, fixed or variable width without
+ * offset table) is read back too, to repack or invert an existing font.
+ *
+ * font  : [size][fixed width|0|FONT_OFFSET_TABLE][height][first][end]
+ *         [width table][offset table][glyph data]           (glcd.h)
+ * bitmap: [width][height][data]                              (glcd_bitmap)
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define FONT_OFFSET_TABLE    0x80     // glcd.h
+#define FONT_PACKBITS        0x40
+#define FONT_WIDTH_MASK      0x3f
+#ifndef FONT_MAX_WIDTH
+#define FONT_MAX_WIDTH       32       // glcd.h, page buffer of packed glyphs
+#endif
+#define MAX_CHARS            256
+#define MAX_WIDTH            255
+#define MAX_HEIGHT           64
+
+typedef struct
+{
+  int     width;                      // pixel, 0 if not in the font
+  uint8_t pixel[MAX_HEIGHT][MAX_WIDTH];
+} tGlyph;
+
+static tGlyph  glyphs[MAX_CHARS];
+static int     fontHeight;
+
+static const char* opt_name;
+static int     opt_first = 32;
+static int     opt_last  = 127;
+static int     opt_offsets;
+static int     opt_pack;
+static int     opt_invert;
+
+static int pages(void);
+
+static void die(const char* msg, const char* arg)
+{
+  fprintf(stderr, "glcdconv: %s %s\n", msg, arg ? arg : "");
+  exit(1);
+}
+
+/*
+ * BDF font
+ */
+static void read_bdf(const char* file)
+{
+  FILE* fp = fopen(file, "r");
+  char  line[512];
+  int   fbbw = 0, fbbh = 0, fbbx = 0, fbby = 0;
+  int   encoding = -1, dwidth = 0, bbw = 0, bbh = 0, bbx = 0, bby = 0;
+  int   row = -1;
+
+  if(!fp) die("can not open", file);
+
+  while(fgets(line, sizeof(line), fp))
+  {
+    if(!strncmp(line, "FONTBOUNDINGBOX ", 16))
+    {
+      sscanf(line+16, "%d %d %d %d", &fbbw, &fbbh, &fbbx, &fbby);
+      if(fbbh < 1 || fbbh > MAX_HEIGHT) die("unsupported font height", file);
+      fontHeight = fbbh;
+    }
+    else
+    if(!strncmp(line, "ENCODING ", 9))
+    {
+      encoding = atoi(line+9);
+    }
+    else
+    if(!strncmp(line, "DWIDTH ", 7))
+    {
+      dwidth = atoi(line+7);
+    }
+    else
+    if(!strncmp(line, "BBX ", 4))
+    {
+      sscanf(line+4, "%d %d %d %d", &bbw, &bbh, &bbx, &bby);
+    }
+    else
+    if(!strncmp(line, "BITMAP", 6))
+    {
+      row = 0;
+      if(encoding >= 0 && encoding < MAX_CHARS)
+      {
+        glyphs[encoding].width = (dwidth > 0 && dwidth <= MAX_WIDTH) ? dwidth : 1;
+      }
+    }
+    else
+    if(!strncmp(line, "ENDCHAR", 7))
+    {
+      row = -1;
+      encoding = -1;
+    }
+    else
+    if(row >= 0)
+    {
+      // one hex row of the glyph bounding box, MSB is the left pixel
+      if(encoding >= 0 && encoding < MAX_CHARS)
+      {
+        int y = (fbbh + fbby) - (bby + bbh) + row;   // from the top of the font
+
+        for(int i=0; i<bbw; i++)
+        {
+          int  x = bbx - fbbx + i;
+          char hex[2] = { line[i/4], 0 };
+          int  nibble = (int)strtol(hex, NULL, 16);
+
+          if(nibble & (8 >> (i%4)))
+          {
+            if(x >= 0 && x < glyphs[encoding].width && y >= 0 && y < fontHeight)
+            {
+              glyphs[encoding].pixel[y][x] = 1;
+            }
+          }
+        }
+      }
+      row++;
+    }
+  }
+  fclose(fp);
+  if(!fontHeight) die("no FONTBOUNDINGBOX in", file);
+}
+
+/*
+ * font header of this library, the first { } of the file
+ */
+static void read_glcdfont(const char* file)
+{
+  FILE* fp = fopen(file, "r");
+  static char text[1 << 20];
+  static uint8_t v[1 << 16];
+  size_t len, n = 0;
+  char*  p;
+
+  if(!fp) die("can not open", file);
+  len = fread(text, 1, sizeof(text)-1, fp);
+  text[len] = 0;
+  fclose(fp);
+
+  p = strchr(text, '{');
+  if(!p) die("no font array in", file);
+
+  // the numbers and character literals up to the closing brace
+  while(*++p && *p != '}')
+  {
+    if(p[0] == '/' && p[1] == '/')      { p = strchr(p, '\n'); if(!p) break; }
+    else
+    if(p[0] == '/' && p[1] == '*')      { p = strstr(p+2, "*/"); if(!p) break; p++; }
+    else
+    if(*p == '\'')
+    {
+      v[n++] = (p[1] == '\\') ? p[2] : p[1];
+      p = strchr(p + ((p[1] == '\\') ? 3 : 2), '\'');
+      if(!p) break;
+    }
+    else
+    if(*p >= '0' && *p <= '9')
+    {
+      v[n++] = (uint8_t)strtol(p, &p, 0);
+      p--;
+    }
+    if(n >= sizeof(v)) die("font too large", file);
+  }
+  if(n < 6) die("short font", file);
+  if(v[2] & (FONT_OFFSET_TABLE|FONT_PACKBITS)) die("offset table or packed font, not supported", file);
+
+  {
+    int width = v[2] & FONT_WIDTH_MASK;
+    int first = v[4], last = v[5];
+    int count = last - first + 1;
+    size_t index = 6 + (width ? 0 : count);
+
+    fontHeight = v[3];
+    if(fontHeight < 1 || fontHeight > MAX_HEIGHT) die("unsupported font height", file);
+    opt_first = first;
+    opt_last  = last;
+
+    for(int c=first; c<=last; c++)
+    {
+      tGlyph* g = &glyphs[c];
+
+      g->width = width ? width : v[6 + c - first];
+      for(int page=0; page<pages(); page++)
+      {
+        for(int x=0; x<g->width; x++, index++)
+        {
+          if(index >= n) die("short font", file);
+          for(int b=0; b<8; b++)
+          {
+            if(page*8+b < fontHeight) g->pixel[page*8+b][x] = (v[index] >> b) & 1;
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+ * monochrome BMP image, into glyph 0
+ */
+static uint32_t le(const uint8_t* p, int n)
+{
+  uint32_t v = 0;
+  while(n--) v = (v << 8) | p[n];
+  return v;
+}
+
+static void read_bmp(const char* file)
+{
+  FILE*    fp = fopen(file, "rb");
+  uint8_t  hdr[62];
+  uint8_t* data;
+  int32_t  width, height;
+  int      topdown = 0;
+  uint32_t offset, stride;
+  uint8_t  palette[8];
+  int      set[2];
+
+  if(!fp) die("can not open", file);
+  if(fread(hdr, 1, sizeof(hdr), fp) != sizeof(hdr) || hdr[0] != 'B' || hdr[1] != 'M') die("not a BMP", file);
+  if(le(hdr+14, 4) < 40) die("OS/2 BMP header not supported", file);
+  if(le(hdr+28, 2) != 1 || le(hdr+30, 4) != 0) die("not an uncompressed 1 bit BMP", file);
+
+  offset = le(hdr+10, 4);
+  width  = (int32_t)le(hdr+18, 4);
+  height = (int32_t)le(hdr+22, 4);
+  if(height < 0)
+  {
+    height  = -height;
+    topdown = 1;
+  }
+  if(width < 1 || width > MAX_WIDTH || height < 1 || height > MAX_HEIGHT) die("unsupported image size", file);
+
+  // the palette follows the info header, 40 bytes or longer (V4, V5)
+  if(fseek(fp, 14 + le(hdr+14, 4), SEEK_SET) || fread(palette, 1, sizeof(palette), fp) != sizeof(palette)) die("short BMP", file);
+
+  // a palette entry is a set pixel if it is dark (B, G, R)
+  for(int i=0; i<2; i++)
+  {
+    const uint8_t* c = palette + i*4;
+    set[i] = (c[0] + c[1] + c[2]) < 3*128;
+  }
+
+  stride = ((width + 31) / 32) * 4;
+  data   = malloc(stride * height);
+  if(!data || fseek(fp, offset, SEEK_SET) || fread(data, 1, stride*height, fp) != stride*height) die("short BMP", file);
+  fclose(fp);
+
+  fontHeight       = height;
+  glyphs[0].width  = width;
+  for(int y=0; y<height; y++)
+  {
+    const uint8_t* r = data + stride * (topdown ? y : height-1-y);
+    for(int x=0; x<width; x++)
+    {
+      glyphs[0].pixel[y][x] = set[(r[x/8] >> (7 - x%8)) & 1];
+    }
+  }
+  free(data);
+}
+
+/*
+ * output
+ */
+static int pages(void)
+{
+  return (fontHeight + 7) / 8;
+}
+
+// a page of a glyph column, bit 0 at the top
+static uint8_t column(const tGlyph* g, int page, int x)
+{
+  uint8_t bits = 0;
+
+  for(int b=0; b<8; b++)
+  {
+    int y = page*8 + b;
+    if(y < fontHeight && g->pixel[y][x]) bits |= 1 << b;
+  }
+  return bits;
+}
+
+static void emit_art(const tGlyph* g)
+{
+  for(int y=0; y<fontHeight; y++)
+  {
+    printf("\t// ");
+    for(int x=0; x<g->width; x++) putchar(g->pixel[y][x] ? '#' : ' ');
+    printf("\n");
+  }
+}
+
+/*
+ * PackBits, n+1 literal bytes or a byte repeated 1-n times
+ */
+static int packbits(const uint8_t* in, int len, uint8_t* out)
+{
+  int i = 0, o = 0;
+
+  while(i < len)
+  {
+    int run = 1;
+
+    while(i+run < len && run < 128 && in[i+run] == in[i]) run++;
+    if(run >= 2)
+    {
+      out[o++] = (uint8_t)(1 - run);
+      out[o++] = in[i];
+      i += run;
+    }
+    else
+    {
+      // literal up to the next run of 3
+      int lit = 1;
+
+      while(i+lit < len && lit < 128 &&
+            !(i+lit+2 < len && in[i+lit] == in[i+lit+1] && in[i+lit] == in[i+lit+2])) lit++;
+      out[o++] = (uint8_t)(lit - 1);
+      memcpy(out+o, in+i, lit);
+      o += lit;
+      i += lit;
+    }
+  }
+  return o;
+}
+
+// the glyph bytes in bus order, packed with -p
+static int glyph_bytes(const tGlyph* g, uint8_t invert, uint8_t* out)
+{
+  uint8_t raw[MAX_WIDTH * MAX_HEIGHT / 8];
+  int n = 0;
+
+  for(int page=0; page<pages(); page++)
+  {
+    for(int x=0; x<g->width; x++) raw[n++] = column(g, page, x) ^ invert;
+  }
+  return opt_pack ? packbits(raw, n, out) : (memcpy(out, raw, n), n);
+}
+
+static void emit_glyph(const tGlyph* g, uint8_t invert)
+{
+  if(opt_pack)
+  {
+    uint8_t packed[MAX_WIDTH * MAX_HEIGHT / 8 * 2];
+    int n = glyph_bytes(g, invert, packed);
+
+    printf("\t");
+    for(int i=0; i<n; i++) printf("0x%02X, ", packed[i]);
+    printf("\n");
+    return;
+  }
+
+  for(int page=0; page<pages(); page++)
+  {
+    printf("\t");
+    for(int x=0; x<g->width; x++) printf("0x%02X, ", (uint8_t)(column(g, page, x) ^ invert));
+    printf("\n");
+  }
+}
+
+static void emit_font(const char* name, uint8_t invert)
+{
+  int fixed = 0;
+  int count = opt_last - opt_first + 1;
+  int widest = 0;
+  long size = 6, offset = 0, data = 0;
+
+  // fixed width if every character has the same width
+  for(int c=opt_first; c<=opt_last; c++)
+  {
+    if(!glyphs[c].width) glyphs[c].width = glyphs[' '].width ? glyphs[' '].width : 1;
+    if(c == opt_first)             fixed = glyphs[c].width;
+    else if(glyphs[c].width != fixed) fixed = 0;
+    if(glyphs[c].width > widest) widest = glyphs[c].width;
+  }
+  if(fixed && opt_offsets && !opt_pack)
+  {
+    fprintf(stderr, "glcdconv: %s is fixed width, no offset table\n", name);
+  }
+  if(fixed > FONT_WIDTH_MASK) die("fixed width too large", name);
+  if(opt_pack && widest > FONT_MAX_WIDTH) die("packed glyph wider than FONT_MAX_WIDTH", name);
+  if(opt_pack) opt_offsets = 1;
+
+  if(!fixed)  size += count;
+  if(opt_offsets && (opt_pack || !fixed)) size += count * 2;
+  for(int c=opt_first; c<=opt_last; c++)
+  {
+    uint8_t bytes[MAX_WIDTH * MAX_HEIGHT / 8 * 2];
+    data += glyph_bytes(&glyphs[c], invert, bytes);
+  }
+  size += data;
+
+  // the size and the glyph offsets are 16 bit
+  if(opt_offsets && (opt_pack || !fixed) && data > 0xffff) die("glyph data over 64KB, the offset table is 16 bit", name);
+  if(size > 0xffff) die("font over 64KB, the size is 16 bit", name);
+
+  if(opt_pack)
+  {
+    char macro[80];
+
+    snprintf(macro, sizeof(macro), "%s_MAX_WIDTH", name);
+    for(char* p=macro; *p; p++) if(*p >= 'a' && *p <= 'z') *p -= 'a' - 'A';
+
+    // glcd_putc unpacks a glyph page into a FONT_MAX_WIDTH buffer
+    printf("// widest glyph, the packed glyph page buffer of glcd.c has to hold it\n");
+    printf("#define %s %d\n", macro, widest);
+    printf("#if defined(FONT_MAX_WIDTH) && (%s > FONT_MAX_WIDTH)\n", macro);
+    printf("#error %s: packed glyphs wider than FONT_MAX_WIDTH\n#endif\n", name);
+    printf("#ifndef FONT_PACKED\n#error %s: packed font, build with -DFONT_PACKED\n#endif\n\n", name);
+  }
+
+  printf("const uint8_t %s[] PROGMEM =\n{\n", name);
+  printf("    0x%02lX, 0x%02lX,\t// Data Size (high byte, low byte)\n", (size >> 8) & 0xff, size & 0xff);
+  printf("    0x%02X,\t\t// Character width  ('0' is Variable width font, use below width table each character)\n",
+         fixed | (opt_pack ? FONT_PACKBITS : ((opt_offsets && !fixed) ? FONT_OFFSET_TABLE : 0)));
+  printf("    %d,\t\t// Character height (pixel)\n", fontHeight);
+  printf("    %d,\t\t// First character\n", opt_first);
+  printf("    %d,\t\t// End character\n", opt_last);
+
+  if(!fixed)
+  {
+    printf("\n\t// width table\n\t");
+    for(int c=opt_first; c<=opt_last; c++) printf("%d, ", glyphs[c].width);
+    printf("\n");
+  }
+
+  if(opt_offsets && (opt_pack || !fixed))
+  {
+    // glyph offsets from the start of the glyph data, high byte first
+    printf("\n\t// offset table\n\t");
+    for(int c=opt_first; c<=opt_last; c++)
+    {
+      uint8_t bytes[MAX_WIDTH * MAX_HEIGHT / 8 * 2];
+
+      printf("0x%02lX, 0x%02lX, ", (offset >> 8) & 0xff, offset & 0xff);
+      offset += glyph_bytes(&glyphs[c], invert, bytes);
+    }
+    printf("\n");
+  }
+
+  offset = 0;
+  for(int c=opt_first; c<=opt_last; c++)
+  {
+    uint8_t bytes[MAX_WIDTH * MAX_HEIGHT / 8 * 2];
+
+    printf("\n\t/* @%ld '%c' (%d pixels wide) */\n", offset, (c >= 32 && c < 127) ? c : '?', glyphs[c].width);
+    emit_art(&glyphs[c]);
+    emit_glyph(&glyphs[c], invert);
+    offset += glyph_bytes(&glyphs[c], invert, bytes);
+  }
+  printf("};\n\n");
+}
+
+static void emit_bitmap(const char* name, uint8_t invert)
+{
+  printf("const uint8_t %s[] PROGMEM =\n{\n", name);
+  printf("  %d, // width\n", glyphs[0].width);
+  printf("  %d, // height\n", pages() * 8);
+  emit_art(&glyphs[0]);
+  emit_glyph(&glyphs[0], invert);
+  printf("};\n\n");
+}
+
+int main(int argc, char** argv)
+{
+  const char* file = NULL;
+  char  name[64];
+  char  guard[80];
+  int   bitmap;
+
+  for(int i=1; i<argc; i++)
+  {
+    if(!strcmp(argv[i], "-n") && i+1 < argc) opt_name  = argv[++i];
+    else
+    if(!strcmp(argv[i], "-f") && i+1 < argc) opt_first = strtol(argv[++i], NULL, 0);
+    else
+    if(!strcmp(argv[i], "-l") && i+1 < argc) opt_last  = strtol(argv[++i], NULL, 0);
+    else
+    if(!strcmp(argv[i], "-o")) opt_offsets = 1;
+    else
+    if(!strcmp(argv[i], "-p")) opt_pack    = 1;
+    else
+    if(!strcmp(argv[i], "-i")) opt_invert  = 1;
+    else
+    if(argv[i][0] != '-' && !file) file = argv[i];
+    else die("usage: glcdconv [-n name] [-f first] [-l last] [-o] [-p] [-i] file.bdf|file.bmp|file.h", NULL);
+  }
+  if(!file) die("usage: glcdconv [-n name] [-f first] [-l last] [-o] [-p] [-i] file.bdf|file.bmp|file.h", NULL);
+  if(opt_first < 0 || opt_last >= MAX_CHARS || opt_first > opt_last) die("bad character range", NULL);
+
+  // default array name, the file name without directory and extension
+  if(!opt_name)
+  {
+    const char* base = strrchr(file, '/') ? strrchr(file, '/') + 1 : file;
+    size_t n = strcspn(base, ".");
+    if(n >= sizeof(name)) n = sizeof(name) - 1;
+    memcpy(name, base, n);
+    name[n] = 0;
+    opt_name = name;
+  }
+
+  bitmap = (strlen(file) > 4) && !strcmp(file + strlen(file) - 4, ".bmp");
+  if(bitmap)                                                   read_bmp(file);
+  else
+  if((strlen(file) > 2) && !strcmp(file + strlen(file) - 2, ".h")) read_glcdfont(file);
+  else                                                         read_bdf(file);
+
+  snprintf(guard, sizeof(guard), "%s_H_", opt_name);
+  for(char* p=guard; *p; p++) if(*p >= 'a' && *p <= 'z') *p -= 'a' - 'A';
+
+  printf("#ifndef %s\n#define %s\n", guard, guard);
+  printf("/*\n * THIS IS COLUMN MAJOR %s, IN LCD BUS ORDER\n *\n", bitmap ? "BITMAP" : "FONT");
+  printf(" * created with glcdconv from %s\n * do not edit, run make fonts\n */\n", file);
+  printf("#include <avr/pgmspace.h>\n\n");
+
+  for(int inv=0; inv <= opt_invert; inv++)
+  {
+    char array[80];
+
+    snprintf(array, sizeof(array), "%s%s", opt_name, inv ? "_inv" : "");
+    if(bitmap) emit_bitmap(array, inv ? 0xff : 0x00);   // bitmaps are never packed
+    else       emit_font(array, inv ? 0xff : 0x00);
+  }
+  printf("#endif\n");
+  return 0;
+}
@@ -0,0 +1,98 @@
+#
+# $Id: isrcycles.awk ssk $
+#
+# Worst case cycles of an interrupt handler, from the extended listing
+# (avr-objdump -h -S, $(TARGET).lss) of the build.
+#
+# usage: awk -v vector=__vector_10 -v budget=3555 -f tools/isrcycles.awk main.lss
+#
+# every instruction of the handler is counted once at its longest time
+# (a branch taken, a skip over a two word instruction), plus the interrupt
+# response. that is an upper bound as long as the handler is straight line
+# code, so a call or a backward branch is an error. the exit status is 1
+# when the bound is not below the budget.
+#
+# cycles: ATmega8 data sheet, Instruction Set Summary. interrupt response:
+# 4 cycles, up to 3 more to finish the instruction in progress, then the
+# rjmp of the vector table (2).
+#
+# MIT License
+#
+# Copyright (c) 2019 ssk.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+BEGIN {
+  FS = "\t"
+  response = 4 + 3 + 2
+  split("ld ldd st std lds sts push pop rjmp ijmp adiw sbiw sbi cbi " \
+        "mul muls mulsu fmul fmuls fmulsu " \
+        "breq brne brcs brcc brsh brlo brmi brpl brge brlt brhs brhc " \
+        "brts brtc brvs brvc brie brid brbs brbc", two, " ")
+  for(i in two) cycles[two[i]] = 2
+  split("cpse sbrc sbrs sbic sbis", skip, " ")
+  for(i in skip) cycles[skip[i]] = 3
+  cycles["lpm"] = 3
+  cycles["elpm"] = 3
+  cycles["ret"] = 4
+  cycles["reti"] = 4
+  split("rcall call icall eicall", calls, " ")
+  for(i in calls) callop[calls[i]] = 1
+}
+
+# a symbol: 0000006c <__vector_10>:
+/^[0-9a-f]+ <[^>]+>:/ {
+  name = $0
+  sub(/^[0-9a-f]+ </, "", name)
+  sub(/>:.*$/, "", name)
+  inside = (name == vector)
+  if(inside) found = 1
+  next
+}
+
+# an instruction:   6c:	1f 92       	push	r1
+inside && NF >= 3 && $1 ~ /^ *[0-9a-f]+:$/ {
+  op = $3
+  gsub(/ /, "", op)
+  if(op == "") next
+  if(op in callop)
+  {
+    printf("isrcycles: %s calls out (%s), no bound\n", vector, $0) > "/dev/stderr"
+    error = 1
+  }
+  if($4 ~ /^\.-/)
+  {
+    printf("isrcycles: %s loops (%s), no bound\n", vector, $0) > "/dev/stderr"
+    error = 1
+  }
+  total += (op in cycles) ? cycles[op] : 1
+  count++
+}
+
+END {
+  if(!found)
+  {
+    printf("isrcycles: %s not found\n", vector) > "/dev/stderr"
+    exit 1
+  }
+  if(error) exit 1
+  total += response
+  printf("%s: %d instructions, worst case %d cycles of %d\n", vector, count, total, budget)
+  if(budget && total >= budget) exit 1
+}